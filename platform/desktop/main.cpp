@@ -1,5 +1,11 @@
 #include "engine/core/Application.hpp"
 #include "engine/Logging.hpp"
+#include "engine/core/FlightRecorder.hpp"
+#include "engine/TemperatureSystem.hpp"
+#include "engine/TickStatsRecorder.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 
 // Simple game application class for desktop
 class DesktopApp : public Application {
@@ -23,7 +29,43 @@ public:
     }
 };
 
-int main() {
+// Headless run: --headless <ticks> [stats.arrows]. Steps the world without
+// opening a window; with a filename, per-tick statistics are written there
+// (TickStatsRecorder.hpp).
+int runHeadless(int argc, char** argv) {
+    if (argc < 1) {
+        LOG_ERROR("Usage: EvolutionSim --headless <ticks> [stats.arrows]");
+        return 1;
+    }
+    const uint64_t ticks = std::strtoull(argv[0], nullptr, 10);
+
+    TemperatureSystem temperatures(1024, 768);
+    temperatures.initialize();
+
+    std::unique_ptr<TickStatsRecorder> stats;
+    if (argc >= 2) {
+        stats = std::make_unique<TickStatsRecorder>(argv[1]);
+        if (!stats->isOpen()) {
+            LOG_ERROR("Could not open stats file");
+            return 1;
+        }
+    }
+
+    for (uint64_t tick = 0; tick < ticks; ++tick) {
+        temperatures.update(tick);
+        if (stats) stats->record(temperatures, tick);
+    }
+    LOG_INFO("Headless run finished");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    FlightRecorder::installCrashHandlers("flight_recorder.txt");
+
+    if (argc >= 2 && std::strcmp(argv[1], "--headless") == 0) {
+        return runHeadless(argc - 2, argv + 2);
+    }
+
     DesktopApp app;
     app.run();
     return 0;
@@ -0,0 +1,124 @@
+#include "IlluminationSystem.hpp"
+#include "TemperatureSystem.hpp"
+#include "world/MaterialGrid.hpp"
+#include "core/JobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Columns per job when rescanning; wide enough for full vector lanes and to
+// keep each row segment on its own cache lines
+constexpr size_t COLUMN_GRAIN = 64;
+
+} // namespace
+
+IlluminationSystem::IlluminationSystem(uint32_t width, uint32_t height)
+    : m_width(width), m_height(height),
+      m_light(static_cast<size_t>(width) * height, 1.0f),
+      m_absorbers(width) {}
+
+float IlluminationSystem::sunIntensity(uint64_t tick) const {
+    if (m_settings.dayLength == 0) return 1.0f;
+
+    // Sun rises at phase 0, peaks at 0.25 and sets at 0.5
+    const double phase = static_cast<double>(tick % m_settings.dayLength) / m_settings.dayLength;
+    const float sun = static_cast<float>(std::sin(2.0 * PI * phase));
+    return std::max(sun, m_settings.nightLevel);
+}
+
+void IlluminationSystem::scanColumns(const MaterialGrid& materials, uint32_t x0, uint32_t x1) {
+    // Per-material transparency, looked up once per cell into a row buffer so
+    // the multiply below is a plain float sweep
+    float transparency[static_cast<size_t>(Material::Count)];
+    for (size_t m = 0; m < static_cast<size_t>(Material::Count); ++m) {
+        transparency[m] = MaterialGrid::properties(static_cast<Material>(m)).transparency;
+    }
+
+    const uint32_t span = x1 - x0;
+    std::vector<float> incoming(span, 1.0f);
+    std::vector<float> passes(span);
+    const uint8_t* ids = materials.data();
+
+    for (uint32_t y = 0; y < m_height; ++y) {
+        const size_t row = static_cast<size_t>(y) * m_width + x0;
+        const uint8_t* rowIds = ids + row;
+        float* light = m_light.data() + row;
+
+        for (uint32_t i = 0; i < span; ++i) {
+            passes[i] = transparency[std::min<uint8_t>(rowIds[i], static_cast<uint8_t>(Material::Count) - 1)];
+        }
+        for (uint32_t i = 0; i < span; ++i) {
+            light[i] = incoming[i];
+            incoming[i] *= passes[i];
+        }
+    }
+
+    // Absorbers per column: walk down until the light runs out, which for
+    // most columns is the first opaque cell
+    const float minLight = m_settings.minLight;
+    for (uint32_t x = x0; x < x1; ++x) {
+        std::vector<Absorber>& absorbers = m_absorbers[x];
+        absorbers.clear();
+        for (uint32_t y = 0; y < m_height; ++y) {
+            const size_t cell = static_cast<size_t>(y) * m_width + x;
+            const float in = m_light[cell];
+            if (in < minLight) break;
+            const float absorbed = in * (1.0f - transparency[std::min<uint8_t>(ids[cell], static_cast<uint8_t>(Material::Count) - 1)]);
+            if (absorbed >= minLight) {
+                absorbers.push_back({y, absorbed});
+            }
+        }
+    }
+}
+
+void IlluminationSystem::refresh(const MaterialGrid& materials) {
+    m_columnsRescanned = 0;
+    if (m_width == 0 || m_height == 0) return;
+    if (materials.getWidth() != m_width || materials.getHeight() != m_height) return;
+    if (m_scanned && materials.getRevision() == m_materialRevision) return;
+
+    // Runs of consecutive changed columns, each scanned as one span
+    struct Run {
+        uint32_t begin;
+        uint32_t end;
+    };
+    std::vector<Run> runs;
+    for (uint32_t x = 0; x < m_width; ) {
+        if (m_scanned && materials.getColumnRevision(x) <= m_materialRevision) {
+            ++x;
+            continue;
+        }
+        const uint32_t begin = x;
+        while (x < m_width && (!m_scanned || materials.getColumnRevision(x) > m_materialRevision) &&
+               x - begin < COLUMN_GRAIN) {
+            ++x;
+        }
+        runs.push_back({begin, x});
+        m_columnsRescanned += x - begin;
+    }
+
+    JobSystem::get().parallelFor(runs.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t r = begin; r < end; ++r) {
+            scanColumns(materials, runs[r].begin, runs[r].end);
+        }
+    });
+
+    m_materialRevision = materials.getRevision();
+    m_scanned = true;
+}
+
+void IlluminationSystem::update(TemperatureSystem& temperatures, const MaterialGrid& materials, uint64_t tick) {
+    refresh(materials);
+    m_sun = sunIntensity(tick);
+    if (!m_scanned || m_sun <= 0.0f || m_settings.heating <= 0.0) return;
+
+    const double scale = m_settings.heating * m_sun;
+    for (uint32_t x = 0; x < m_width; ++x) {
+        for (const Absorber& a : m_absorbers[x]) {
+            temperatures.addHeat(x, a.y, a.absorbed * scale);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TemperatureSystem;
+class MaterialGrid;
+
+// Sunlight reaching each cell, from a top-down scan of every column.
+//
+// Light enters at the top of the map and each cell passes on its material's
+// transparency fraction of what reaches it; the remainder is absorbed. The
+// scan runs row by row over a span of columns, so the inner loop is a
+// contiguous sweep across columns and vectorizes.
+//
+// The stored field is relative to full sun and does not depend on time of
+// day: the day-night cycle is a single scalar applied when it is read and when
+// absorbed light is turned into heat. Only columns whose materials changed
+// (MaterialGrid::getColumnRevision) are rescanned.
+class IlluminationSystem {
+public:
+    struct Settings {
+        uint32_t dayLength = 2400;     // Ticks per full day-night cycle
+        float nightLevel = 0.0f;       // Sun intensity floor at night (0-1)
+        double heating = 0.02;         // Degrees per tick for a fully absorbed full sun
+        float minLight = 1e-4f;        // Light below this is treated as darkness
+    };
+
+    IlluminationSystem(uint32_t width, uint32_t height);
+
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& getSettings() const { return m_settings; }
+
+    // Rescan changed columns, advance the day cycle to `tick` and heat
+    // absorbing cells through TemperatureSystem::addHeat()
+    void update(TemperatureSystem& temperatures, const MaterialGrid& materials, uint64_t tick);
+
+    // Rescan changed columns only (no heating)
+    void refresh(const MaterialGrid& materials);
+
+    // Sun intensity (0-1) at `tick` and as of the last update()
+    float sunIntensity(uint64_t tick) const;
+    float getSunIntensity() const { return m_sun; }
+
+    // Light falling on cell (x, y) at the current time of day (0-1)
+    float getIllumination(uint32_t x, uint32_t y) const {
+        return m_light[static_cast<size_t>(y) * m_width + x] * m_sun;
+    }
+
+    // Row-major full-sun light field; multiply by getSunIntensity() for now
+    const float* getLightData() const { return m_light.data(); }
+
+    // Columns rescanned by the last refresh, for profiling
+    uint32_t getColumnsRescanned() const { return m_columnsRescanned; }
+
+private:
+    // A cell that absorbs a noticeable share of full sun
+    struct Absorber {
+        uint32_t y;
+        float absorbed;   // Fraction of full sun absorbed (0-1)
+    };
+
+    void scanColumns(const MaterialGrid& materials, uint32_t x0, uint32_t x1);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    Settings m_settings;
+
+    std::vector<float> m_light;                         // Row-major, light reaching each cell
+    std::vector<std::vector<Absorber>> m_absorbers;     // Per column, top to bottom
+    uint64_t m_materialRevision = 0;                    // Material revision of the last scan
+    bool m_scanned = false;
+    float m_sun = 1.0f;
+    uint32_t m_columnsRescanned = 0;
+};
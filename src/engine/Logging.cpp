@@ -1,4 +1,6 @@
 #include "Logging.hpp"
+#include "core/FlightRecorder.hpp"
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
@@ -9,6 +11,15 @@
 #endif
 
 void Logger::log(LogLevel level, const char* file, int line, const std::string& message) {
+    // Warnings and errors also go to the crash flight recorder, labelled
+    // with the source file (a literal, so the pointer stays valid)
+    if (level == LogLevel::Warning || level == LogLevel::Error) {
+        const char* base = std::strrchr(file, '/');
+        FlightRecorder::recordText(level == LogLevel::Error ? FlightRecorder::EventType::Error
+                                                            : FlightRecorder::EventType::Warning,
+                                   base ? base + 1 : file, message.c_str());
+    }
+    
     // Get current time
     std::time_t now = std::time(nullptr);
     std::tm timeInfo = *std::localtime(&now);
@@ -0,0 +1,202 @@
+#include "RadiationSystem.hpp"
+#include "TemperatureSystem.hpp"
+#include "world/MaterialGrid.hpp"
+#include "core/JobSystem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double KELVIN_OFFSET = 273.15;
+constexpr double REFERENCE_KELVIN = 293.15;
+
+// Black-body power T^4, scaled by the slope at room temperature so that
+// differences come out in roughly degrees
+double radiantPower(double celsius) {
+    const double k = std::max(0.0, celsius + KELVIN_OFFSET);
+    const double k2 = k * k;
+    return k2 * k2 / (4.0 * REFERENCE_KELVIN * REFERENCE_KELVIN * REFERENCE_KELVIN);
+}
+
+} // namespace
+
+RadiationSystem::RadiationSystem(uint32_t width, uint32_t height)
+    : m_width(width), m_height(height) {}
+
+void RadiationSystem::rebuildMaterialData(const MaterialGrid& materials) {
+    const size_t cells = static_cast<size_t>(m_width) * m_height;
+    m_cellEmissivity.resize(cells);
+    m_scratch.resize(cells);
+    m_receivers.clear();
+
+    const uint8_t* ids = materials.data();
+    for (size_t i = 0; i < cells; ++i) {
+        const MaterialProperties& props = MaterialGrid::properties(static_cast<Material>(ids[i]));
+        m_cellEmissivity[i] = props.emissivity;
+        m_scratch[i] = props.transparency;
+        if (props.emissivity > 0.0f) {
+            m_receivers.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    m_transparency.build(m_scratch.data(), m_width, m_height);
+    m_emissivity.build(m_cellEmissivity.data(), m_width, m_height);
+
+    m_cursor = 0;
+    m_materialRevision = materials.getRevision();
+}
+
+void RadiationSystem::update(TemperatureSystem& temperatures, const MaterialGrid& materials) {
+    m_interactions = 0;
+    if (m_width == 0 || m_height == 0) return;
+    if (materials.getWidth() != m_width || materials.getHeight() != m_height) return;
+    if (temperatures.getGrid().width != m_width || temperatures.getGrid().height != m_height) return;
+
+    if (materials.getRevision() != m_materialRevision) {
+        rebuildMaterialData(materials);
+    }
+    if (m_receivers.empty()) return;
+
+    // Emission pyramid from this tick's temperatures
+    const size_t cells = static_cast<size_t>(m_width) * m_height;
+    m_temperature.resize(cells);
+    temperatures.copyTemperatures(m_temperature.data());
+    for (size_t i = 0; i < cells; ++i) {
+        m_scratch[i] = m_cellEmissivity[i] > 0.0 ? m_cellEmissivity[i] * radiantPower(m_temperature[i]) : 0.0;
+    }
+    m_emission.build(m_scratch.data(), m_width, m_height);
+
+    // Round-robin batch; each visit stands in for the whole revisit period
+    const size_t batch = std::min<size_t>(m_settings.receiversPerTick, m_receivers.size());
+    const double period = static_cast<double>(m_receivers.size()) / static_cast<double>(std::max<size_t>(batch, 1));
+    m_deltas.assign(batch, 0.0);
+
+    std::atomic<uint64_t> interactions{0};
+    JobSystem::get().parallelFor(batch, [&](size_t begin, size_t end, unsigned) {
+        uint64_t local = 0;
+        for (size_t b = begin; b < end; ++b) {
+            const uint32_t cell = m_receivers[(m_cursor + b) % m_receivers.size()];
+            const uint32_t rx = cell % m_width;
+            const uint32_t ry = cell / m_width;
+            const double net = gather(rx, ry, radiantPower(m_temperature[cell]), local);
+            const double delta = m_settings.coupling * m_cellEmissivity[cell] * net * period;
+            m_deltas[b] = std::clamp(delta, -m_settings.maxDelta, m_settings.maxDelta);
+        }
+        interactions += local;
+    }, 64);
+    m_interactions = interactions.load();
+
+    for (size_t b = 0; b < batch; ++b) {
+        const uint32_t cell = m_receivers[(m_cursor + b) % m_receivers.size()];
+        temperatures.addHeat(cell % m_width, cell / m_width, m_deltas[b]);
+    }
+    m_cursor = (m_cursor + batch) % m_receivers.size();
+}
+
+double RadiationSystem::gather(uint32_t rx, uint32_t ry, double receiverPower, uint64_t& interactions) const {
+    struct Node {
+        uint32_t level;
+        uint32_t x;
+        uint32_t y;
+    };
+    // Depth-first: at most 3 siblings wait per level, plus the node being opened
+    Node stack[4 * 32];
+    size_t top = 0;
+    stack[top++] = {static_cast<uint32_t>(m_emission.levelCount() - 1), 0, 0};
+
+    const double px = rx;
+    const double py = ry;
+    const double theta = m_settings.openingAngle;
+    double net = 0.0;
+
+    while (top > 0) {
+        const Node node = stack[--top];
+        const double emissivity = m_emissivity.at(node.level, node.x, node.y);
+        if (emissivity <= 0.0) continue;
+
+        const uint32_t size = 1u << node.level;
+        const uint32_t x0 = node.x * size;
+        const uint32_t y0 = node.y * size;
+        const uint32_t w = std::min(size, m_width - x0);
+        const uint32_t h = std::min(size, m_height - y0);
+        const bool containsReceiver = rx >= x0 && rx < x0 + w && ry >= y0 && ry < y0 + h;
+
+        if (node.level == 0 && containsReceiver) continue;
+
+        const double cx = x0 + 0.5 * (w - 1);
+        const double cy = y0 + 0.5 * (h - 1);
+        const double dist2 = (cx - px) * (cx - px) + (cy - py) * (cy - py);
+        const double dist = std::sqrt(dist2);
+
+        if (node.level > 0 && (containsReceiver || size >= theta * dist)) {
+            const size_t below = node.level - 1;
+            for (uint32_t j = 0; j < 2; ++j) {
+                for (uint32_t i = 0; i < 2; ++i) {
+                    const uint32_t cxIdx = 2 * node.x + i;
+                    const uint32_t cyIdx = 2 * node.y + j;
+                    if (cxIdx < m_emission.levelWidth(below) && cyIdx < m_emission.levelHeight(below)) {
+                        stack[top++] = {static_cast<uint32_t>(below), cxIdx, cyIdx};
+                    }
+                }
+            }
+            continue;
+        }
+
+        ++interactions;
+        const double tau = transmittance(px, py, cx, cy, node.level, node.x, node.y);
+        if (tau <= 0.0) continue;
+
+        // View factor of a unit cell at distance d, capped for touching cells
+        const double viewFactor = std::min(1.0, 1.0 / (PI * dist2));
+        const double exchange = m_emission.at(node.level, node.x, node.y) - receiverPower * emissivity;
+        net += viewFactor * tau * exchange;
+    }
+    return net;
+}
+
+double RadiationSystem::transmittance(double x0, double y0, double x1, double y1,
+                                      size_t nodeLevel, uint32_t nodeX, uint32_t nodeY) const {
+    const double dx = x1 - x0;
+    const double dy = y1 - y0;
+    const double dist = std::sqrt(dx * dx + dy * dy);
+    if (dist <= 1.0) return 1.0;
+
+    // Coarsest level that still gives at most maxVisibilitySteps samples
+    size_t level = 0;
+    const double maxSteps = std::max<uint32_t>(1, m_settings.maxVisibilitySteps);
+    while (level + 1 < m_transparency.levelCount() && dist / static_cast<double>(1u << level) > maxSteps) {
+        ++level;
+    }
+    const uint32_t cellSize = 1u << level;
+    const int steps = static_cast<int>(std::ceil(dist / cellSize));
+    const double stepLength = dist / steps;
+
+    const uint32_t nodeSize = 1u << nodeLevel;
+    const double nodeLeft = static_cast<double>(nodeX) * nodeSize - 0.5;
+    const double nodeTop = static_cast<double>(nodeY) * nodeSize - 0.5;
+
+    double tau = 1.0;
+    for (int i = 0; i < steps; ++i) {
+        const double t = (i + 0.5) / steps;
+        const double sx = x0 + dx * t;
+        const double sy = y0 + dy * t;
+
+        // Skip the receiver's own cell and the source node's footprint
+        if (std::fabs(sx - x0) < 0.5 && std::fabs(sy - y0) < 0.5) continue;
+        if (sx >= nodeLeft && sx < nodeLeft + nodeSize && sy >= nodeTop && sy < nodeTop + nodeSize) continue;
+
+        const int cx = static_cast<int>(std::lround(sx)) >> level;
+        const int cy = static_cast<int>(std::lround(sy)) >> level;
+        if (cx < 0 || cy < 0 ||
+            cx >= static_cast<int>(m_transparency.levelWidth(level)) ||
+            cy >= static_cast<int>(m_transparency.levelHeight(level))) {
+            continue;
+        }
+        const double mean = m_transparency.at(level, cx, cy) /
+                            m_transparency.cellCount(level, cx, cy);
+        tau *= mean >= 1.0 ? 1.0 : std::pow(mean, stepLength);
+        if (tau < 1e-3) return 0.0;
+    }
+    return tau;
+}
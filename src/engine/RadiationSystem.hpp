@@ -0,0 +1,67 @@
+#pragma once
+
+#include "field/MipPyramid.hpp"
+#include <cstdint>
+#include <vector>
+
+class TemperatureSystem;
+class MaterialGrid;
+
+// Long-range radiative heat exchange between cells.
+//
+// Exact exchange is O(N^2). Instead each receiver walks a mip pyramid of
+// emitted power Barnes-Hut style: a node far enough away (size / distance <
+// openingAngle) is treated as one source at its centre, nearer nodes are
+// opened into their four children. Exchange with each accepted node is
+// attenuated by the transparency of the materials along the line between them,
+// sampled from a transparency pyramid at a level that keeps the march under
+// maxVisibilitySteps samples.
+//
+// Per-tick cost is bounded by receiversPerTick: emitting cells (emissivity > 0)
+// are visited round-robin, and each visit applies the exchange for the whole
+// revisit period. Results go through TemperatureSystem::addHeat().
+class RadiationSystem {
+public:
+    struct Settings {
+        double openingAngle = 0.5;          // Barnes-Hut acceptance threshold
+        double coupling = 1e-4;             // Net exchange to degrees per tick
+        double maxDelta = 50.0;             // Clamp on one visit's temperature change
+        uint32_t receiversPerTick = 4096;   // Per-tick work budget
+        uint32_t maxVisibilitySteps = 16;   // Transparency samples per interaction
+    };
+
+    RadiationSystem(uint32_t width, uint32_t height);
+
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& getSettings() const { return m_settings; }
+
+    // Exchange heat for the next batch of receivers
+    void update(TemperatureSystem& temperatures, const MaterialGrid& materials);
+
+    // Node interactions evaluated by the last update(), for profiling
+    uint64_t getInteractionCount() const { return m_interactions; }
+
+private:
+    void rebuildMaterialData(const MaterialGrid& materials);
+    double gather(uint32_t rx, uint32_t ry, double receiverPower, uint64_t& interactions) const;
+    double transmittance(double x0, double y0, double x1, double y1,
+                         size_t nodeLevel, uint32_t nodeX, uint32_t nodeY) const;
+
+    uint32_t m_width;
+    uint32_t m_height;
+    Settings m_settings;
+
+    MipPyramid m_emission;       // Sum of emissivity * power
+    MipPyramid m_emissivity;     // Sum of emissivity
+    MipPyramid m_transparency;   // Sum of per-cell transparency
+
+    uint64_t m_materialRevision = UINT64_MAX;
+    std::vector<double> m_cellEmissivity;  // Row-major, from materials
+    std::vector<uint32_t> m_receivers;     // Cells with emissivity > 0
+    size_t m_cursor = 0;
+
+    std::vector<double> m_temperature;     // Row-major snapshot for this tick
+    std::vector<double> m_scratch;
+    std::vector<double> m_deltas;
+    uint64_t m_interactions = 0;
+};
@@ -0,0 +1,43 @@
+#include "SimulationTasks.hpp"
+#include "TemperatureSystem.hpp"
+#include <algorithm>
+
+namespace {
+
+// Cells initialized per advance() call
+constexpr size_t INIT_CELLS_PER_UNIT = 65536;
+
+} // namespace
+
+InitializeTask::InitializeTask(TemperatureSystem& system)
+    : m_system(system), m_units(system.getInitializationUnits()) {
+    setPhase("Initializing world");
+}
+
+bool InitializeTask::advance() {
+    if (m_units == 0) return true;
+
+    // Units are rows or 32x32 tiles; size the slice by cell count
+    const auto& grid = m_system.getGrid();
+    const size_t cellsPerUnit = std::max<size_t>(1, static_cast<size_t>(grid.width) * grid.height / m_units);
+    const size_t step = std::max<size_t>(1, INIT_CELLS_PER_UNIT / cellsPerUnit);
+
+    const size_t end = std::min(m_units, m_cursor + step);
+    m_system.initializeUnits(m_cursor, end);
+    m_cursor = end;
+    setProgress(static_cast<double>(m_cursor) / m_units);
+    return m_cursor == m_units;
+}
+
+FastForwardTask::FastForwardTask(TemperatureSystem& system, uint64_t ticks)
+    : m_system(system), m_ticks(ticks) {
+    setPhase("Fast-forwarding");
+}
+
+bool FastForwardTask::advance() {
+    if (m_done >= m_ticks) return true;
+    m_system.update(1);
+    ++m_done;
+    setProgress(static_cast<double>(m_done) / m_ticks);
+    return m_done == m_ticks;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "core/ResumableTask.hpp"
+#include <cstddef>
+#include <cstdint>
+
+class TemperatureSystem;
+
+// World (re)initialization in slices of rows / tiles. The system must
+// outlive the task and should not be updated until the task is Done.
+class InitializeTask : public ResumableTask {
+public:
+    explicit InitializeTask(TemperatureSystem& system);
+
+protected:
+    bool advance() override;
+
+private:
+    TemperatureSystem& m_system;
+    size_t m_units;
+    size_t m_cursor = 0;
+};
+
+// Run `ticks` update() steps, one per unit, for fast-forwarding without
+// blocking the frame. For very long jumps on periodic worlds
+// TemperatureSystem::advanceSpectral() is cheaper but cannot be sliced.
+class FastForwardTask : public ResumableTask {
+public:
+    FastForwardTask(TemperatureSystem& system, uint64_t ticks);
+
+    uint64_t getTicksDone() const { return m_done; }
+
+protected:
+    bool advance() override;
+
+private:
+    TemperatureSystem& m_system;
+    uint64_t m_ticks;
+    uint64_t m_done = 0;
+};
@@ -1,89 +1,386 @@
 #include "TemperatureSystem.hpp"
+#include "field/Stencil.hpp"
+#include "field/SpectralDiffusion.hpp"
+#include "core/FlightRecorder.hpp"
+#include "core/JobSystem.hpp"
+#include "Logging.hpp"
 #include <cmath>
+#include <cstring>
 #include <algorithm>
+#include <mutex>
+#include <string>
 
-TemperatureSystem::TemperatureSystem(uint32_t width, uint32_t height, double ambientTemp)
-    : grid{std::vector<std::vector<Cell>>(height, std::vector<Cell>(width)), width, height, ambientTemp} {
+TemperatureSystem::TemperatureSystem(uint32_t width, uint32_t height, double ambientTemp,
+                                     GridLayout::Kind layout, UpdateScheme updateScheme)
+    : grid{{}, {}, width, height, GridLayout(layout, width, height), ambientTemp, 0} {
+    if (updateScheme == UpdateScheme::RedBlack && grid.layout.isTiled()) {
+        LOG_WARNING("Red-black updates need the row-major layout");
+        updateScheme = UpdateScheme::Jacobi;
+    }
+    scheme = updateScheme;
+
+    // Planes are allocated untouched; initialize() writes them band by band
+    grid.temperature.resize(grid.layout.storageSize());
+    if (scheme == UpdateScheme::Jacobi) {
+        grid.nextTemperature.resize(grid.layout.storageSize());
+    }
     initialize();
 }
 
+TemperatureSystem::~TemperatureSystem() = default;
+
 void TemperatureSystem::initialize() {
+    // Each worker writes the band it will later update, so on first call
+    // (fresh allocation) its pages are placed on that worker's NUMA node
+    forEachBand([&](const Band& band) {
+        initializeBand(band);
+    });
+    grid.lastUpdate = 0;
+}
+
+void TemperatureSystem::initializeUnits(size_t begin, size_t end) {
+    end = std::min(end, bandUnits());
+    if (begin >= end) return;
+    initializeBand(makeBand(begin, end, 0));
+    if (end == bandUnits()) {
+        grid.lastUpdate = 0;
+    }
+}
+
+void TemperatureSystem::initializeBand(const Band& band) {
     const double centerX = grid.width / 2.0;
     const double centerY = grid.height / 2.0;
     const double maxDist = std::sqrt(centerX * centerX + centerY * centerY);
-    
-    for (uint32_t y = 0; y < grid.height; ++y) {
-        for (uint32_t x = 0; x < grid.width; ++x) {
-            double dx = x - centerX;
-            double dy = y - centerY;
-            double dist = std::sqrt(dx * dx + dy * dy) / maxDist;
-            
-            // Initialize with temperature gradient (warmer in center)
-            grid.cells[y][x] = {
-                grid.ambientTemperature * (1.0 - dist * 0.5),
-                grid.ambientTemperature * (1.0 - dist * 0.5),
-                0
-            };
+    const bool hasNext = !grid.nextTemperature.empty();
+
+    std::fill(grid.temperature.begin() + band.first, grid.temperature.begin() + band.last,
+              grid.ambientTemperature);
+
+    auto initCell = [&](uint32_t x, uint32_t y) {
+        double dx = x - centerX;
+        double dy = y - centerY;
+        double dist = std::sqrt(dx * dx + dy * dy) / maxDist;
+
+        // Initialize with temperature gradient (warmer in center)
+        grid.temperature[grid.index(x, y)] = grid.ambientTemperature * (1.0 - dist * 0.5);
+    };
+
+    if (!grid.layout.isTiled()) {
+        for (size_t y = band.begin; y < band.end; ++y) {
+            for (uint32_t x = 0; x < grid.width; ++x) {
+                initCell(x, static_cast<uint32_t>(y));
+            }
+        }
+    } else {
+        for (size_t slot = band.begin; slot < band.end; ++slot) {
+            uint32_t tx, ty;
+            grid.layout.tileAtSlot(slot, tx, ty);
+            const uint32_t x0 = tx << GridLayout::TILE_SHIFT;
+            const uint32_t y0 = ty << GridLayout::TILE_SHIFT;
+            const uint32_t x1 = std::min(grid.width, x0 + GridLayout::TILE_SIZE);
+            const uint32_t y1 = std::min(grid.height, y0 + GridLayout::TILE_SIZE);
+            for (uint32_t y = y0; y < y1; ++y) {
+                for (uint32_t x = x0; x < x1; ++x) {
+                    initCell(x, y);
+                }
+            }
         }
     }
+
+    if (hasNext) {
+        std::copy(grid.temperature.begin() + band.first, grid.temperature.begin() + band.last,
+                  grid.nextTemperature.begin() + band.first);
+    }
+}
+
+size_t TemperatureSystem::bandUnits() const {
+    return grid.layout.isTiled() ? grid.layout.tileCount() : grid.height;
+}
+
+size_t TemperatureSystem::bandGrain() const {
+    return grid.layout.isTiled() ? 1 : ROW_BAND_GRAIN;
+}
+
+TemperatureSystem::Band TemperatureSystem::makeBand(size_t begin, size_t end, unsigned worker) const {
+    Band band{begin, end, 0, 0, worker};
+    if (grid.layout.isTiled()) {
+        band.first = begin * GridLayout::TILE_CELLS;
+        band.last = end * GridLayout::TILE_CELLS;
+    } else {
+        // Rows [begin, end) plus the ghost rows above / below the grid
+        const size_t units = bandUnits();
+        const size_t stride = grid.layout.rowStride();
+        band.first = begin == 0 ? 0 : (begin + 1) * stride;
+        band.last = end == units ? grid.layout.storageSize() : (end + 1) * stride;
+    }
+    return band;
+}
+
+void TemperatureSystem::forEachBand(const std::function<void(const Band&)>& fn) const {
+    JobSystem::get().parallelFor(bandUnits(), [&](size_t begin, size_t end, unsigned worker) {
+        fn(makeBand(begin, end, worker));
+    }, bandGrain());
+}
+
+GridMemory::NumaReport TemperatureSystem::checkNumaPlacement() const {
+    // Sample up to this many pages per band
+    constexpr size_t SAMPLES_PER_BAND = 64;
+    constexpr size_t PAGE_SIZE = 4096;
+
+    GridMemory::NumaReport report;
+    report.workerNodes.assign(JobSystem::get().getWorkerCount(), -1);
+    std::mutex mutex;
+    bool supported = true;
+
+    const char* base = reinterpret_cast<const char*>(grid.temperature.data());
+    forEachBand([&](const Band& band) {
+        const int node = GridMemory::currentNode();
+        const size_t bytes = (band.last - band.first) * sizeof(double);
+        const size_t pages = std::max<size_t>(1, bytes / PAGE_SIZE);
+        const size_t step = std::max<size_t>(1, pages / SAMPLES_PER_BAND);
+
+        std::vector<const void*> addresses;
+        for (size_t p = 0; p < pages && addresses.size() < SAMPLES_PER_BAND; p += step) {
+            addresses.push_back(base + band.first * sizeof(double) + p * PAGE_SIZE);
+        }
+        std::vector<int> nodes(addresses.size());
+        const bool ok = GridMemory::pageNodes(addresses.data(), addresses.size(), nodes.data());
+
+        size_t local = 0;
+        for (int pageNode : nodes) {
+            if (node >= 0 && pageNode == node) ++local;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        supported = supported && ok && node >= 0;
+        report.pagesSampled += addresses.size();
+        report.pagesLocal += local;
+        report.workerNodes[band.worker] = node;
+    });
+    report.supported = supported;
+
+    LOG_INFO("NUMA placement: " + std::to_string(report.pagesLocal) + "/" +
+             std::to_string(report.pagesSampled) + " sampled grid pages local to their worker" +
+             (report.supported ? "" : " (placement not reported on this platform)"));
+    return report;
 }
 
 void TemperatureSystem::update(uint64_t deltaTime) {
+    updateCoarse(deltaTime, 1);
+}
+
+void TemperatureSystem::updateCoarse(uint64_t deltaTime, uint32_t ticks) {
+    FlightRecorder::recordTick("temperature.update", deltaTime);
+
     // First, calculate next temperatures
-    diffuseTemperature();
-    
-    // Then apply the changes
-    for (auto& row : grid.cells) {
-        for (auto& cell : row) {
-            cell.temperature = cell.nextTemperature;
-            cell.lastUpdate = deltaTime;
-        }
+    diffuseTemperature(std::max<uint32_t>(1, ticks));
+
+    // Then apply the changes (RedBlack already updated in place)
+    if (scheme == UpdateScheme::Jacobi) {
+        grid.temperature.swap(grid.nextTemperature);
     }
+    applyPendingHeat();
+    grid.lastUpdate = deltaTime;
+}
+
+void TemperatureSystem::addHeat(uint32_t x, uint32_t y, double delta) {
+    if (!isValidPosition(x, y)) return;
+    pendingHeat.push_back({grid.index(x, y), delta});
+}
+
+void TemperatureSystem::applyPendingHeat() {
+    double* temp = grid.temperature.data();
+    for (const HeatSource& source : pendingHeat) {
+        temp[source.index] += source.delta;
+    }
+    pendingHeat.clear();
+}
+
+bool TemperatureSystem::advanceSpectral(double ticks) {
+    if (boundary.kind != BoundaryKind::Periodic) {
+        LOG_WARNING("advanceSpectral() needs a periodic boundary; grid left unchanged");
+        return false;
+    }
+    if (ticks <= 0.0) return true;
+
+    switch (stencil) {
+        case StencilKind::FivePoint:
+            advanceSpectralWith<FivePointStencil>(ticks, DIFFUSION_RATE, DIFFUSION_RATE);
+            break;
+        case StencilKind::NinePoint:
+            advanceSpectralWith<NinePointStencil>(ticks, DIFFUSION_RATE, DIFFUSION_RATE);
+            break;
+        case StencilKind::Anisotropic:
+            advanceSpectralWith<AnisotropicStencil>(ticks, anisotropicRateX, anisotropicRateY);
+            break;
+    }
+    return true;
 }
 
 double TemperatureSystem::getTemperature(uint32_t x, uint32_t y) const {
     if (!isValidPosition(x, y)) return grid.ambientTemperature;
-    return grid.cells[y][x].temperature;
+    return grid.temperature[grid.index(x, y)];
 }
 
 void TemperatureSystem::setTemperature(uint32_t x, uint32_t y, double temp) {
     if (isValidPosition(x, y)) {
-        grid.cells[y][x].temperature = temp;
-        grid.cells[y][x].nextTemperature = temp;
+        grid.temperature[grid.index(x, y)] = temp;
+        if (!grid.nextTemperature.empty()) {
+            grid.nextTemperature[grid.index(x, y)] = temp;
+        }
+    }
+}
+
+void TemperatureSystem::copyTemperatures(double* out) const {
+    grid.layout.gather(grid.temperature.data(), out);
+}
+
+void TemperatureSystem::loadTemperatures(const double* in) {
+    grid.layout.scatter(in, grid.temperature.data());
+    if (!grid.nextTemperature.empty()) {
+        grid.layout.scatter(in, grid.nextTemperature.data());
     }
 }
 
+bool TemperatureSystem::setUpdateScheme(UpdateScheme newScheme) {
+    if (newScheme == UpdateScheme::RedBlack) {
+        if (grid.layout.isTiled()) {
+            LOG_WARNING("Red-black updates need the row-major layout");
+            return false;
+        }
+        FieldPlane().swap(grid.nextTemperature);
+    } else if (grid.nextTemperature.size() != grid.temperature.size()) {
+        grid.nextTemperature.resize(grid.temperature.size());
+        forEachBand([&](const Band& band) {
+            std::copy(grid.temperature.begin() + band.first, grid.temperature.begin() + band.last,
+                      grid.nextTemperature.begin() + band.first);
+        });
+    }
+    scheme = newScheme;
+    return true;
+}
+
+void TemperatureSystem::setAnisotropicRates(double rateX, double rateY) {
+    anisotropicRateX = std::clamp(rateX, 0.0, 1.0);
+    anisotropicRateY = std::clamp(rateY, 0.0, 1.0);
+}
+
 bool TemperatureSystem::isValidPosition(int x, int y) const {
     return x >= 0 && y >= 0 && x < static_cast<int>(grid.width) && y < static_cast<int>(grid.height);
 }
 
-void TemperatureSystem::diffuseTemperature() {
-    // Simple diffusion: each cell's temperature moves towards the average of its neighbors
-    const int dirs[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
-    
-    for (uint32_t y = 0; y < grid.height; ++y) {
-        for (uint32_t x = 0; x < grid.width; ++x) {
-            double sum = 0.0;
-            int count = 0;
-            
-            // Check all 4 neighbors
-            for (const auto& dir : dirs) {
-                int nx = x + dir[0];
-                int ny = y + dir[1];
-                
-                if (isValidPosition(nx, ny)) {
-                    sum += grid.cells[ny][nx].temperature;
-                    count++;
-                }
+void TemperatureSystem::diffuseTemperature(uint32_t ticks) {
+    // A cell keeps (1 - rate) of its own heat per tick, so `ticks` ticks
+    // folded into one pass keep (1 - rate)^ticks
+    const auto compound = [ticks](double rate) {
+        return ticks == 1 ? rate : 1.0 - std::pow(1.0 - rate, static_cast<double>(ticks));
+    };
+
+    // Dispatch once per tick; each branch is a fully unrolled kernel
+    switch (stencil) {
+        case StencilKind::FivePoint:
+            diffuseWith<FivePointStencil>(compound(DIFFUSION_RATE), compound(DIFFUSION_RATE));
+            break;
+        case StencilKind::NinePoint:
+            diffuseWith<NinePointStencil>(compound(DIFFUSION_RATE), compound(DIFFUSION_RATE));
+            break;
+        case StencilKind::Anisotropic:
+            diffuseWith<AnisotropicStencil>(compound(anisotropicRateX), compound(anisotropicRateY));
+            break;
+    }
+}
+
+template <typename S>
+void TemperatureSystem::diffuseWith(double rateX, double rateY) {
+    // Each cell's temperature moves towards the weighted average of its neighbors.
+    // The ghost ring (or the tile halo) supplies the out-of-bounds taps, so
+    // every cell takes the same branch-free path whatever the boundary type.
+    const StencilCoefficients<S> c(rateX, rateY);
+    if (scheme == UpdateScheme::RedBlack) {
+        relaxInPlace<S>(c);
+        return;
+    }
+
+    const double* src = grid.temperature.data();
+    double* dst = grid.nextTemperature.data();
+
+    if (!grid.layout.isTiled()) {
+        refreshGhostRing(grid.temperature.data(), grid.width, grid.height, grid.layout.rowStride(), boundary);
+        const std::ptrdiff_t stride = static_cast<std::ptrdiff_t>(grid.layout.rowStride());
+
+        JobSystem::get().parallelFor(grid.height, [&](size_t begin, size_t end, unsigned) {
+            for (size_t y = begin; y < end; ++y) {
+                const size_t row = grid.index(0, static_cast<uint32_t>(y));
+                diffuseRow<S>(src + row, dst + row, stride, 0, grid.width, c);
             }
-            
-            if (count > 0) {
-                double avg = sum / count;
-                double diff = (avg - grid.cells[y][x].temperature) * DIFFUSION_RATE;
-                grid.cells[y][x].nextTemperature = grid.cells[y][x].temperature + diff;
-            } else {
-                grid.cells[y][x].nextTemperature = grid.cells[y][x].temperature;
+        }, bandGrain());
+        return;
+    }
+
+    // Tiled: each worker takes a run of tiles in memory order, copies tile
+    // plus halo to a scratch buffer and runs the row kernel on it
+    JobSystem::get().parallelFor(grid.layout.tileCount(), [&](size_t begin, size_t end, unsigned) {
+        double scratch[HALO_TILE_SIZE * HALO_TILE_SIZE];
+        for (size_t slot = begin; slot < end; ++slot) {
+            uint32_t tx, ty;
+            grid.layout.tileAtSlot(slot, tx, ty);
+            grid.layout.gatherTileHalo(src, tx, ty, boundary, scratch);
+
+            const uint32_t w = std::min(GridLayout::TILE_SIZE, grid.width - (tx << GridLayout::TILE_SHIFT));
+            const uint32_t h = std::min(GridLayout::TILE_SIZE, grid.height - (ty << GridLayout::TILE_SHIFT));
+            double* tile = dst + slot * GridLayout::TILE_CELLS;
+            for (uint32_t ly = 0; ly < h; ++ly) {
+                diffuseRow<S>(scratch + (ly + 1) * HALO_TILE_SIZE + 1,
+                              tile + (static_cast<size_t>(ly) << GridLayout::TILE_SHIFT),
+                              HALO_TILE_SIZE, 0, w, c);
             }
         }
+    }, bandGrain());
+}
+
+template <typename S>
+void TemperatureSystem::relaxInPlace(const StencilCoefficients<S>& c) {
+    // Colour passes: cells of one colour only read cells of other colours, so
+    // each pass updates in place and its rows can run in parallel. The ghost
+    // ring is refreshed before every pass so it sees the latest edge values.
+    constexpr bool fourColours = hasDiagonalTaps<S>();
+    constexpr unsigned colours = fourColours ? 4 : 2;
+    double* plane = grid.temperature.data();
+    const std::ptrdiff_t stride = static_cast<std::ptrdiff_t>(grid.layout.rowStride());
+
+    for (unsigned colour = 0; colour < colours; ++colour) {
+        refreshGhostRing(plane, grid.width, grid.height, grid.layout.rowStride(), boundary);
+
+        JobSystem::get().parallelFor(grid.height, [&](size_t begin, size_t end, unsigned) {
+            for (size_t y = begin; y < end; ++y) {
+                uint32_t x0;
+                if (fourColours) {
+                    if ((y & 1) != (colour >> 1)) continue;
+                    x0 = colour & 1;
+                } else {
+                    x0 = static_cast<uint32_t>((y + colour) & 1);
+                }
+                relaxRowInPlace<S>(plane + grid.index(0, static_cast<uint32_t>(y)), stride, x0, grid.width, c);
+            }
+        }, bandGrain());
     }
 }
+
+template <typename S>
+void TemperatureSystem::advanceSpectralWith(double ticks, double rateX, double rateY) {
+    if (!spectral) {
+        spectral = std::make_unique<SpectralDiffusion>(grid.width, grid.height);
+    }
+
+    const StencilCoefficients<S> c(rateX, rateY);
+    std::vector<SpectralDiffusion::Tap> taps;
+    taps.reserve(S::size);
+    for (std::size_t i = 0; i < S::size; ++i) {
+        taps.push_back({S::taps[i].dx, S::taps[i].dy, c.coeff[i]});
+    }
+
+    std::vector<double> field(static_cast<size_t>(grid.width) * grid.height);
+    copyTemperatures(field.data());
+    spectral->advance(field.data(), ticks, c.centre, taps);
+    loadTemperatures(field.data());
+}
@@ -1,46 +1,172 @@
 #pragma once
 
 #include <vector>
+#include <functional>
+#include <memory>
+#include <cstddef>
 #include <cstdint>
+#include "field/Boundary.hpp"
+#include "field/GridLayout.hpp"
+#include "field/Stencil.hpp"
+#include "memory/GridAllocator.hpp"
+
+class SpectralDiffusion;
 
 class TemperatureSystem {
 public:
-    struct Cell {
-        double temperature;      // Current temperature in Celsius
-        double nextTemperature;  // Temperature for next update
-        uint64_t lastUpdate;     // Timestamp of last update
+    // Diffusion stencil used by update() (see field/Stencil.hpp)
+    enum class StencilKind {
+        FivePoint,    // 4 edge neighbours
+        NinePoint,    // Edge and corner neighbours, near-isotropic spread
+        Anisotropic   // 4 edge neighbours with separate x/y rates
+    };
+
+    // How update() applies the stencil
+    enum class UpdateScheme {
+        Jacobi,    // Read temperature, write nextTemperature, swap
+        RedBlack   // In-place checkerboard Gauss-Seidel; no nextTemperature plane
     };
-    
+
+    // Planes are stored in `layout` order (row-major with a ghost ring, or
+    // 32x32 tiles), so always address cells through index().
     struct Grid {
-        std::vector<std::vector<Cell>> cells;
+        FieldPlane temperature;      // Current temperature in Celsius
+        FieldPlane nextTemperature;  // Temperature for next update (empty for RedBlack)
         uint32_t width;
         uint32_t height;
+        GridLayout layout;
         double ambientTemperature;
+        uint64_t lastUpdate;                  // Timestamp of last update
+
+        size_t index(uint32_t x, uint32_t y) const { return layout.index(x, y); }
     };
 
-    TemperatureSystem(uint32_t width, uint32_t height, double ambientTemp = 20.0);
-    ~TemperatureSystem() = default;
+    TemperatureSystem(uint32_t width, uint32_t height, double ambientTemp = 20.0,
+                      GridLayout::Kind layout = GridLayout::Kind::RowMajor,
+                      UpdateScheme scheme = UpdateScheme::Jacobi);
+    ~TemperatureSystem();
 
     // Initialize the grid with default temperatures
     void initialize();
-    
+
+    // Initialize part of the grid: units are rows (RowMajor) or tile slots
+    // (tiled layouts), [0, getInitializationUnits()). Lets InitializeTask
+    // (SimulationTasks.hpp) spread initialize() over several frames.
+    size_t getInitializationUnits() const { return bandUnits(); }
+    void initializeUnits(size_t begin, size_t end);
+
     // Update temperatures (should be called each frame)
     void update(uint64_t deltaTime);
-    
+
+    // Stand-in for `ticks` update() calls at the cost of one, for when the
+    // frame budget is short (core/QualityGovernor.hpp). The diffusion rate is
+    // compounded to 1 - (1 - rate)^ticks, so each cell keeps as much of its
+    // own heat as after `ticks` passes, but heat only reaches direct
+    // neighbours. The rate stays below 1, so the pass is always stable.
+    void updateCoarse(uint64_t deltaTime, uint32_t ticks);
+
+    // Jump forward by `ticks` update() steps at once (fractional counts allowed)
+    // using the FFT solver in field/SpectralDiffusion.hpp. Cost is O(N log N)
+    // regardless of `ticks`. Only valid on periodic worlds; returns false and
+    // leaves the grid untouched for any other boundary.
+    bool advanceSpectral(double ticks);
+
     // Get/set temperature for a specific cell
     double getTemperature(uint32_t x, uint32_t y) const;
     void setTemperature(uint32_t x, uint32_t y, double temp);
-    
+
+    // Heat source API: queue a temperature change for a cell. Queued heat is
+    // added after the next diffusion step and then cleared, so subsystems
+    // (radiation, sunlight) call this every tick they contribute.
+    void addHeat(uint32_t x, uint32_t y, double delta);
+
+    // Copy the whole field to / from a dense row-major width x height array,
+    // whatever the storage layout. Used by exporters and the save system.
+    void copyTemperatures(double* out) const;
+    void loadTemperatures(const double* in);
+
+    // Select the diffusion stencil. Anisotropic uses the rates set below;
+    // the isotropic stencils use DIFFUSION_RATE.
+    void setStencil(StencilKind kind) { stencil = kind; }
+    StencilKind getStencil() const { return stencil; }
+    void setAnisotropicRates(double rateX, double rateY);
+
+    // Switch update scheme. RedBlack halves field memory by dropping the
+    // nextTemperature plane and relaxes towards equilibrium faster, but follows
+    // a different trajectory than Jacobi and, like any Gauss-Seidel sweep, does
+    // not conserve total heat exactly. It needs the RowMajor layout; returns
+    // false (scheme unchanged) otherwise.
+    bool setUpdateScheme(UpdateScheme scheme);
+    UpdateScheme getUpdateScheme() const { return scheme; }
+
+    // What lies beyond the map edge. Defaults to an insulated (Neumann) wall;
+    // Periodic makes the world toroidal.
+    void setBoundary(BoundaryKind kind, double fixedTemp = 0.0) { boundary = {kind, fixedTemp}; }
+    const BoundaryCondition& getBoundary() const { return boundary; }
+
+    // Sample where the grid's pages live relative to the workers that update
+    // them, and log a one-line summary. Linux only; elsewhere the report comes
+    // back with supported = false.
+    GridMemory::NumaReport checkNumaPlacement() const;
+
     // Get the underlying grid (for rendering)
     const Grid& getGrid() const { return grid; }
 
 private:
     Grid grid;
-    
+    StencilKind stencil = StencilKind::FivePoint;
+    UpdateScheme scheme = UpdateScheme::Jacobi;
+    BoundaryCondition boundary;
+    double anisotropicRateX = DIFFUSION_RATE;
+    double anisotropicRateY = DIFFUSION_RATE;
+    std::unique_ptr<SpectralDiffusion> spectral;  // Created on first advanceSpectral()
+
+    // Heat queued by addHeat(), applied after the next diffusion step. Sources
+    // are few next to the cell count, so they are kept as a list, not a plane.
+    struct HeatSource {
+        size_t index;   // grid.index() of the cell
+        double delta;
+    };
+    std::vector<HeatSource> pendingHeat;
+
     // Temperature diffusion rate (0-1)
     static constexpr double DIFFUSION_RATE = 0.05;
-    
+
+    // Scratch tile for tiled layouts: one tile plus a one-cell halo
+    static constexpr uint32_t HALO_TILE_SIZE = GridLayout::HALO_TILE_SIZE;
+
+    // Rows per band for row-major passes
+    static constexpr size_t ROW_BAND_GRAIN = 16;
+
+    // One worker's share of a banded pass: rows (or tile slots) [begin, end)
+    // and the plane storage [first, last) they own, ghost rows included
+    struct Band {
+        size_t begin;
+        size_t end;
+        size_t first;
+        size_t last;
+        unsigned worker;
+    };
+
+    // Every parallel pass over the grid splits it the same way, so a worker
+    // keeps updating the pages it touched first in initialize()
+    size_t bandUnits() const;
+    size_t bandGrain() const;
+    Band makeBand(size_t begin, size_t end, unsigned worker) const;
+    void forEachBand(const std::function<void(const Band&)>& fn) const;
+    void initializeBand(const Band& band);
+
     // Helper functions
     bool isValidPosition(int x, int y) const;
-    void diffuseTemperature();
+    void diffuseTemperature(uint32_t ticks = 1);
+    void applyPendingHeat();
+
+    template <typename S>
+    void diffuseWith(double rateX, double rateY);
+
+    template <typename S>
+    void relaxInPlace(const StencilCoefficients<S>& c);
+
+    template <typename S>
+    void advanceSpectralWith(double ticks, double rateX, double rateY);
 };
@@ -0,0 +1,121 @@
+#include "TickStatsRecorder.hpp"
+#include "TemperatureSystem.hpp"
+#include "core/JobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+using EvolutionSim::ColumnarWriter;
+
+namespace {
+
+// Column order; histogram bins follow COLUMN_HISTOGRAM
+enum Column : size_t {
+    COLUMN_TICK,
+    COLUMN_MEAN,
+    COLUMN_MIN,
+    COLUMN_MAX,
+    COLUMN_SCHEME,
+    COLUMN_NONFINITE,
+    COLUMN_HISTOGRAM
+};
+
+constexpr size_t CELL_GRAIN = 16384;
+
+std::vector<ColumnarWriter::Column> makeColumns(uint32_t bins) {
+    std::vector<ColumnarWriter::Column> columns = {
+        {"tick", ColumnarWriter::ColumnType::Int64},
+        {"mean_temp", ColumnarWriter::ColumnType::Float64},
+        {"min_temp", ColumnarWriter::ColumnType::Float64},
+        {"max_temp", ColumnarWriter::ColumnType::Float64},
+        {"update_scheme", ColumnarWriter::ColumnType::String},
+        {"nonfinite_cells", ColumnarWriter::ColumnType::Int64}
+    };
+    for (uint32_t i = 0; i < bins; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "temp_hist_%02u", i);
+        columns.push_back({name, ColumnarWriter::ColumnType::Int64});
+    }
+    return columns;
+}
+
+const char* schemeName(TemperatureSystem::UpdateScheme scheme) {
+    switch (scheme) {
+        case TemperatureSystem::UpdateScheme::Jacobi: return "jacobi";
+        case TemperatureSystem::UpdateScheme::RedBlack: return "red_black";
+    }
+    return "";
+}
+
+} // namespace
+
+TickStatsRecorder::TickStatsRecorder(const std::string& filename)
+    : TickStatsRecorder(filename, Settings()) {}
+
+TickStatsRecorder::TickStatsRecorder(const std::string& filename, const Settings& settings)
+    : m_settings(settings),
+      m_writer(std::make_unique<ColumnarWriter>(filename, makeColumns(settings.histogramBins))) {
+    m_settings.interval = std::max<uint32_t>(1, m_settings.interval);
+}
+
+void TickStatsRecorder::record(const TemperatureSystem& system, uint64_t tick) {
+    if (!isOpen() || tick % m_settings.interval != 0) return;
+
+    const auto& grid = system.getGrid();
+    const size_t cells = static_cast<size_t>(grid.width) * grid.height;
+    m_scratch.resize(cells);
+    system.copyTemperatures(m_scratch.data());
+
+    auto& jobs = JobSystem::get();
+    const size_t bins = m_settings.histogramBins;
+    const double binScale = bins / std::max(1e-12, m_settings.histogramMax - m_settings.histogramMin);
+    m_partials.assign(jobs.getWorkerCount(), Partial{std::numeric_limits<double>::max(),
+                                                     std::numeric_limits<double>::lowest(), 0.0, 0});
+    m_binCounts.assign(jobs.getWorkerCount() * bins, 0);
+
+    jobs.parallelFor(cells, [&](size_t begin, size_t end, unsigned worker) {
+        Partial p = m_partials[worker];
+        uint64_t* counts = m_binCounts.data() + worker * bins;
+        for (size_t i = begin; i < end; ++i) {
+            const double t = m_scratch[i];
+            // A NaN would clamp to NaN and index the histogram out of bounds
+            if (!std::isfinite(t)) {
+                ++p.nonFinite;
+                continue;
+            }
+            p.min = std::min(p.min, t);
+            p.max = std::max(p.max, t);
+            p.sum += t;
+            if (bins) {
+                const double bin = (t - m_settings.histogramMin) * binScale;
+                counts[static_cast<size_t>(std::clamp(bin, 0.0, static_cast<double>(bins - 1)))]++;
+            }
+        }
+        m_partials[worker] = p;
+    }, CELL_GRAIN);
+
+    Partial total = m_partials[0];
+    for (size_t w = 1; w < m_partials.size(); ++w) {
+        total.min = std::min(total.min, m_partials[w].min);
+        total.max = std::max(total.max, m_partials[w].max);
+        total.sum += m_partials[w].sum;
+        total.nonFinite += m_partials[w].nonFinite;
+    }
+    const size_t finite = cells - total.nonFinite;
+
+    m_writer->SetInt(COLUMN_TICK, static_cast<int64_t>(tick));
+    m_writer->SetDouble(COLUMN_MEAN, finite ? total.sum / static_cast<double>(finite) : 0.0);
+    m_writer->SetDouble(COLUMN_MIN, finite ? total.min : 0.0);
+    m_writer->SetDouble(COLUMN_MAX, finite ? total.max : 0.0);
+    m_writer->SetString(COLUMN_SCHEME, schemeName(system.getUpdateScheme()));
+    m_writer->SetInt(COLUMN_NONFINITE, static_cast<int64_t>(total.nonFinite));
+    for (size_t b = 0; b < bins; ++b) {
+        uint64_t count = 0;
+        for (size_t w = 0; w < m_partials.size(); ++w) {
+            count += m_binCounts[w * bins + b];
+        }
+        m_writer->SetInt(COLUMN_HISTOGRAM + b, static_cast<int64_t>(count));
+    }
+    m_writer->EndRow();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "serialization/ColumnarWriter.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TemperatureSystem;
+
+// Per-tick world statistics for headless runs, appended to an Arrow IPC
+// stream (EvolutionSim::ColumnarWriter) that loads straight into pandas or
+// polars.
+//
+// Columns: tick, mean_temp, min_temp, max_temp, update_scheme (dictionary
+// string), nonfinite_cells and temp_hist_00 ... one count per histogram bin.
+// Values outside the histogram range land in the first or last bin; NaN and
+// infinite cells are only counted in nonfinite_cells. The reduction runs on
+// the job system; encoding and disk writes happen on the writer's thread.
+class TickStatsRecorder {
+public:
+    struct Settings {
+        uint32_t interval = 1;         // Record every n-th tick
+        uint32_t histogramBins = 16;
+        double histogramMin = -50.0;   // Celsius
+        double histogramMax = 150.0;
+    };
+
+    explicit TickStatsRecorder(const std::string& filename);
+    TickStatsRecorder(const std::string& filename, const Settings& settings);
+
+    bool isOpen() const { return m_writer->IsOpen(); }
+    const Settings& getSettings() const { return m_settings; }
+
+    // Append a row for `tick` if it falls on the interval
+    void record(const TemperatureSystem& system, uint64_t tick);
+
+    // Write out buffered rows and end the stream (also done on destruction)
+    void close() { m_writer->Close(); }
+
+private:
+    struct Partial {
+        double min;
+        double max;
+        double sum;
+        size_t nonFinite;
+    };
+
+    Settings m_settings;
+    std::unique_ptr<EvolutionSim::ColumnarWriter> m_writer;
+    std::vector<double> m_scratch;
+    std::vector<Partial> m_partials;     // Per worker
+    std::vector<uint64_t> m_binCounts;   // Per worker, histogramBins each
+};
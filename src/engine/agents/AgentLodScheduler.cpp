@@ -0,0 +1,212 @@
+#include "AgentLodScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+
+AgentLodScheduler::AgentLodScheduler()
+    : AgentLodScheduler(Settings()) {}
+
+AgentLodScheduler::AgentLodScheduler(const Settings& settings)
+    : m_settings(settings) {
+    if (m_settings.tiers.empty()) {
+        m_settings.tiers.push_back({std::numeric_limits<float>::infinity(), 1});
+    }
+    if (m_settings.tiers.size() > 255) {
+        m_settings.tiers.resize(255);
+    }
+    for (Tier& tier : m_settings.tiers) {
+        tier.period = std::clamp<uint32_t>(tier.period, 1, MAX_PERIOD);
+    }
+    m_settings.reclassifyFrames = std::max<uint32_t>(1, m_settings.reclassifyFrames);
+    m_classifiedViewport = m_viewport;
+    rebuildBuckets();
+}
+
+uint32_t AgentLodScheduler::getPeriod(size_t tier) const {
+    const uint32_t period = m_settings.tiers[tier].period;
+    if (tier == 0) return period;
+    return static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(period) << m_lodBias, MAX_PERIOD));
+}
+
+size_t AgentLodScheduler::getTierPopulation(size_t tier) const {
+    return m_tiers[tier].population;
+}
+
+void AgentLodScheduler::resize(size_t count) {
+    const size_t old = m_agents.size();
+    if (count < old) {
+        for (size_t agent = count; agent < old; ++agent) {
+            unplace(static_cast<uint32_t>(agent));
+        }
+        m_due.erase(std::remove_if(m_due.begin(), m_due.end(),
+                                   [count](uint32_t agent) { return agent >= count; }),
+                    m_due.end());
+        m_agents.resize(count);
+        m_cursor = m_cursor < count ? m_cursor : 0;
+        return;
+    }
+
+    m_agents.resize(count);
+    for (size_t agent = old; agent < count; ++agent) {
+        m_agents[agent].lastUpdate = m_time;
+        place(static_cast<uint32_t>(agent), 0);
+    }
+}
+
+void AgentLodScheduler::permute(const std::vector<uint32_t>& order) {
+    if (order.size() != m_agents.size()) return;
+
+    m_remap.resize(order.size());
+    std::vector<AgentState> agents(order.size());
+    for (size_t agent = 0; agent < order.size(); ++agent) {
+        agents[agent] = m_agents[order[agent]];
+        m_remap[order[agent]] = static_cast<uint32_t>(agent);
+    }
+    m_agents.swap(agents);
+
+    // Bucket positions (AgentState::slot) are unchanged; only the ids in
+    // the buckets change
+    for (TierBuckets& tier : m_tiers) {
+        for (std::vector<uint32_t>& bucket : tier.buckets) {
+            for (uint32_t& agent : bucket) {
+                agent = m_remap[agent];
+            }
+        }
+    }
+    for (uint32_t& agent : m_due) {
+        agent = m_remap[agent];
+    }
+}
+
+void AgentLodScheduler::setViewport(const Viewport& viewport) {
+    m_viewport = viewport;
+    if (viewportJumped()) {
+        m_reclassifyAll = true;
+    }
+}
+
+bool AgentLodScheduler::viewportJumped() const {
+    // Infinite edges (the default, unbounded viewport) compare equal to
+    // themselves and never count as a jump
+    const auto moved = [this](float a, float b) {
+        return a != b && !(std::fabs(a - b) <= m_settings.viewportJump);
+    };
+    return moved(m_viewport.minX, m_classifiedViewport.minX) ||
+           moved(m_viewport.minY, m_classifiedViewport.minY) ||
+           moved(m_viewport.maxX, m_classifiedViewport.maxX) ||
+           moved(m_viewport.maxY, m_classifiedViewport.maxY);
+}
+
+void AgentLodScheduler::setActivity(size_t agent, Activity activity) {
+    AgentState& a = m_agents[agent];
+    a.activity = activity;
+    // Promote at once so it updates next frame; demotion waits for the
+    // next reclassification, which has its position
+    if (activity == Activity::Active && a.tier != 0) {
+        unplace(static_cast<uint32_t>(agent));
+        place(static_cast<uint32_t>(agent), 0);
+    }
+}
+
+void AgentLodScheduler::setLodBias(uint32_t bias) {
+    bias = std::min<uint32_t>(bias, 12);
+    if (bias == m_lodBias) return;
+    m_lodBias = bias;
+    rebuildBuckets();
+}
+
+uint8_t AgentLodScheduler::classify(size_t agent, float x, float y) const {
+    const Activity activity = m_agents[agent].activity;
+    if (activity == Activity::Active) return 0;
+
+    // Chebyshev distance to the viewport rectangle, 0 inside it
+    const float dx = std::max({m_viewport.minX - x, x - m_viewport.maxX, 0.0f});
+    const float dy = std::max({m_viewport.minY - y, y - m_viewport.maxY, 0.0f});
+    const float distance = std::max(dx, dy);
+
+    const size_t last = m_settings.tiers.size() - 1;
+    size_t tier = 0;
+    while (tier < last && distance > m_settings.tiers[tier].distance) {
+        ++tier;
+    }
+    if (activity == Activity::Idle && tier < last) {
+        ++tier;
+    }
+    return static_cast<uint8_t>(tier);
+}
+
+void AgentLodScheduler::reclassify(uint32_t agent, const float* xs, const float* ys) {
+    const uint8_t tier = classify(agent, xs[agent], ys[agent]);
+    if (tier != m_agents[agent].tier) {
+        unplace(agent);
+        place(agent, tier);
+    }
+}
+
+void AgentLodScheduler::beginFrame(double dt, const float* xs, const float* ys) {
+    m_time += dt;
+    const size_t count = m_agents.size();
+
+    if (m_reclassifyAll) {
+        for (size_t agent = 0; agent < count; ++agent) {
+            reclassify(static_cast<uint32_t>(agent), xs, ys);
+        }
+        m_classifiedViewport = m_viewport;
+        m_reclassifyAll = false;
+    } else if (count > 0) {
+        // Agents that just updated have moved; the rolling slice catches
+        // everyone else whose distance changed with the viewport
+        for (uint32_t agent : m_due) {
+            reclassify(agent, xs, ys);
+        }
+        const size_t slice = (count + m_settings.reclassifyFrames - 1) / m_settings.reclassifyFrames;
+        for (size_t i = 0; i < slice; ++i) {
+            reclassify(static_cast<uint32_t>(m_cursor), xs, ys);
+            m_cursor = m_cursor + 1 < count ? m_cursor + 1 : 0;
+        }
+    }
+
+    m_due.clear();
+    for (size_t tier = 0; tier < m_tiers.size(); ++tier) {
+        const std::vector<uint32_t>& bucket = m_tiers[tier].buckets[m_frame % getPeriod(tier)];
+        m_due.insert(m_due.end(), bucket.begin(), bucket.end());
+    }
+    ++m_frame;
+}
+
+void AgentLodScheduler::place(uint32_t agent, uint8_t tier) {
+    TierBuckets& t = m_tiers[tier];
+    const uint32_t bucket = t.nextBucket;
+    t.nextBucket = bucket + 1 < t.buckets.size() ? bucket + 1 : 0;
+
+    AgentState& a = m_agents[agent];
+    a.tier = tier;
+    a.bucket = static_cast<uint16_t>(bucket);
+    a.slot = static_cast<uint32_t>(t.buckets[bucket].size());
+    t.buckets[bucket].push_back(agent);
+    ++t.population;
+}
+
+void AgentLodScheduler::unplace(uint32_t agent) {
+    AgentState& a = m_agents[agent];
+    if (a.slot == NO_SLOT) return;
+
+    TierBuckets& t = m_tiers[a.tier];
+    std::vector<uint32_t>& bucket = t.buckets[a.bucket];
+    const uint32_t moved = bucket.back();
+    bucket[a.slot] = moved;
+    m_agents[moved].slot = a.slot;
+    bucket.pop_back();
+    --t.population;
+    a.slot = NO_SLOT;
+}
+
+void AgentLodScheduler::rebuildBuckets() {
+    m_tiers.assign(m_settings.tiers.size(), TierBuckets());
+    for (size_t tier = 0; tier < m_tiers.size(); ++tier) {
+        m_tiers[tier].buckets.resize(getPeriod(tier));
+    }
+    for (size_t agent = 0; agent < m_agents.size(); ++agent) {
+        m_agents[agent].slot = NO_SLOT;
+        place(static_cast<uint32_t>(agent), m_agents[agent].tier);
+    }
+}
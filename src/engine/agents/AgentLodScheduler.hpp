@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Decides which agents update this frame, by distance from the viewport and
+// by activity.
+//
+// Agents are dense indices [0, size()) into whatever store owns them. Each
+// sits in a tier: tier 0 updates every frame, tier t every `period` frames.
+// A tier's agents are spread over `period` round-robin buckets and one
+// bucket is due per frame, so a far tier costs 1/period of its population
+// each frame instead of all of it every period-th frame. Due agents are
+// handed the time since their own last update, so integration stays right
+// whatever the tier.
+//
+// Tiers are picked from the distance (in cells) to the viewport rectangle.
+// Active agents (fighting, selected, being probed) always use tier 0; idle
+// ones drop one tier further out. Agents are reclassified when they update
+// and, in a rolling slice, every frame; a viewport jump reclassifies
+// everyone on the next frame. Not thread-safe.
+class AgentLodScheduler {
+public:
+    static constexpr uint32_t MAX_PERIOD = 1u << 12;
+
+    struct Tier {
+        float distance;   // Agents up to this far outside the viewport use the tier
+        uint32_t period;  // Update every n-th frame
+    };
+
+    struct Settings {
+        std::vector<Tier> tiers = {
+            {0.0f, 1},
+            {32.0f, 2},
+            {128.0f, 8},
+            {std::numeric_limits<float>::infinity(), 32}
+        };
+        uint32_t reclassifyFrames = 16;  // Rolling reclassification covers everyone this often
+        float viewportJump = 16.0f;      // Viewport moves further than this (cells) reclassify all
+    };
+
+    struct Viewport {
+        float minX = 0.0f;
+        float minY = 0.0f;
+        float maxX = std::numeric_limits<float>::infinity();
+        float maxY = std::numeric_limits<float>::infinity();
+    };
+
+    enum class Activity : uint8_t {
+        Idle,
+        Normal,
+        Active
+    };
+
+    AgentLodScheduler();
+    explicit AgentLodScheduler(const Settings& settings);
+
+    // Agents [0, count); new ones start in tier 0 and update next frame
+    void resize(size_t count);
+    size_t size() const { return m_agents.size(); }
+
+    // Follow a reordering of the agents' store: agent i becomes the agent
+    // that was at order[i] (CreatureStore::getPermutation()). Tiers, buckets
+    // and update times move with the agents. Ignored unless order covers
+    // all size() agents.
+    void permute(const std::vector<uint32_t>& order);
+
+    void setViewport(const Viewport& viewport);
+    void setActivity(size_t agent, Activity activity);
+
+    // Stretch the periods of tiers past 0 by 2^bias (QualityGovernor agentLod).
+    // Periods are capped at MAX_PERIOD.
+    void setLodBias(uint32_t bias);
+    uint32_t getLodBias() const { return m_lodBias; }
+
+    // Start a frame of `dt` (seconds or ticks; it is only summed).
+    // Reclassifies against positions `xs`, `ys` (indexed like the agents)
+    // and collects the agents due this frame.
+    void beginFrame(double dt, const float* xs, const float* ys);
+
+    // Call fn(agent, elapsed) for every agent due this frame, with the time
+    // since it last updated
+    template <typename Fn>
+    void forEachDue(Fn&& fn) {
+        for (uint32_t agent : m_due) {
+            AgentState& a = m_agents[agent];
+            const double elapsed = m_time - a.lastUpdate;
+            a.lastUpdate = m_time;
+            fn(agent, elapsed);
+        }
+    }
+
+    const std::vector<uint32_t>& getDue() const { return m_due; }
+    uint8_t getTier(size_t agent) const { return m_agents[agent].tier; }
+    size_t getTierCount() const { return m_settings.tiers.size(); }
+    size_t getTierPopulation(size_t tier) const;
+    uint32_t getPeriod(size_t tier) const;
+
+private:
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+    struct AgentState {
+        double lastUpdate = 0.0;
+        uint32_t slot = NO_SLOT;    // Position in its bucket
+        uint16_t bucket = 0;
+        uint8_t tier = 0;
+        Activity activity = Activity::Normal;
+    };
+
+    // One list per round-robin bucket
+    struct TierBuckets {
+        std::vector<std::vector<uint32_t>> buckets;
+        size_t population = 0;
+        uint32_t nextBucket = 0;  // New arrivals go round the buckets in turn
+    };
+
+    uint8_t classify(size_t agent, float x, float y) const;
+    void reclassify(uint32_t agent, const float* xs, const float* ys);
+    void place(uint32_t agent, uint8_t tier);
+    void unplace(uint32_t agent);
+    void rebuildBuckets();
+    bool viewportJumped() const;
+
+    Settings m_settings;
+    Viewport m_viewport;
+    Viewport m_classifiedViewport;
+    uint32_t m_lodBias = 0;
+    bool m_reclassifyAll = false;
+
+    std::vector<AgentState> m_agents;
+    std::vector<TierBuckets> m_tiers;
+    std::vector<uint32_t> m_due;
+    std::vector<uint32_t> m_remap;  // permute() scratch: new index of each old one
+    uint64_t m_frame = 0;
+    double m_time = 0.0;
+    size_t m_cursor = 0;  // Rolling reclassification position
+};
@@ -0,0 +1,221 @@
+#include "CreatureStore.hpp"
+#include "core/JobSystem.hpp"
+#include "field/GridLayout.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Creatures per band in the parallel passes
+constexpr size_t CREATURE_GRAIN = 4096;
+
+// Morton bits per 32x32 tile; keys shifted by this compare tiles
+constexpr uint32_t TILE_KEY_SHIFT = 2 * GridLayout::TILE_SHIFT;
+
+uint32_t cellCoord(float v, uint32_t size) {
+    if (!(v > 0.0f)) return 0;  // Also NaN
+    return std::min(static_cast<uint32_t>(std::min(v, 4.0e9f)), size - 1);
+}
+
+template <typename T>
+void gather(std::vector<T>& values, const std::vector<uint32_t>& order, std::vector<T>& scratch) {
+    scratch.resize(values.size());
+    JobSystem::get().parallelFor(order.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t slot = begin; slot < end; ++slot) {
+            scratch[slot] = values[order[slot]];
+        }
+    }, CREATURE_GRAIN);
+    values.swap(scratch);
+}
+
+} // namespace
+
+CreatureStore::CreatureStore(uint32_t width, uint32_t height)
+    : CreatureStore(width, height, Settings()) {}
+
+CreatureStore::CreatureStore(uint32_t width, uint32_t height, const Settings& settings)
+    : m_settings(settings)
+    , m_width(std::max<uint32_t>(1, width))
+    , m_height(std::max<uint32_t>(1, height)) {
+    // mortonEncode2D() keeps 16 bits per axis
+    uint32_t bits = 0;
+    while (bits < 16 && (1u << bits) < std::max(m_width, m_height)) {
+        ++bits;
+    }
+    m_keyBits = 2 * bits;
+    m_settings.disorderCheckInterval = std::max<uint32_t>(1, m_settings.disorderCheckInterval);
+}
+
+CreatureStore::Handle CreatureStore::spawn(float x, float y, GenomeStore::GenomeId genome, float energy) {
+    uint32_t index;
+    if (!m_freeIndices.empty()) {
+        index = m_freeIndices.back();
+        m_freeIndices.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_slotOf.size());
+        m_slotOf.push_back(NO_SLOT);
+        m_generations.push_back(1);
+    }
+
+    m_slotOf[index] = static_cast<uint32_t>(m_x.size());
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_vx.push_back(0.0f);
+    m_vy.push_back(0.0f);
+    m_energy.push_back(energy);
+    m_genome.push_back(genome);
+    m_handleOf.push_back(index);
+    return makeHandle(index, m_generations[index]);
+}
+
+bool CreatureStore::isAlive(Handle handle) const {
+    const uint32_t index = indexOf(handle);
+    return handle != NO_CREATURE && index < m_slotOf.size() && m_slotOf[index] != NO_SLOT &&
+           m_generations[index] == static_cast<uint32_t>(handle >> 32);
+}
+
+bool CreatureStore::despawn(Handle handle) {
+    if (!isAlive(handle)) return false;
+    const uint32_t index = indexOf(handle);
+    const uint32_t slot = m_slotOf[index];
+    const uint32_t last = static_cast<uint32_t>(m_x.size() - 1);
+
+    // Move the last creature into the hole
+    if (slot != last) {
+        m_x[slot] = m_x[last];
+        m_y[slot] = m_y[last];
+        m_vx[slot] = m_vx[last];
+        m_vy[slot] = m_vy[last];
+        m_energy[slot] = m_energy[last];
+        m_genome[slot] = m_genome[last];
+        m_handleOf[slot] = m_handleOf[last];
+        m_slotOf[m_handleOf[slot]] = slot;
+    }
+    m_x.pop_back();
+    m_y.pop_back();
+    m_vx.pop_back();
+    m_vy.pop_back();
+    m_energy.pop_back();
+    m_genome.pop_back();
+    m_handleOf.pop_back();
+
+    m_slotOf[index] = NO_SLOT;
+    ++m_generations[index];
+    m_freeIndices.push_back(index);
+    return true;
+}
+
+uint32_t CreatureStore::mortonKey(size_t slot) const {
+    return mortonEncode2D(cellCoord(m_x[slot], m_width), cellCoord(m_y[slot], m_height));
+}
+
+float CreatureStore::measureDisorder() const {
+    const size_t count = size();
+    if (count < 2) return 0.0f;
+    size_t backwards = 0;
+    uint32_t previous = mortonKey(0) >> TILE_KEY_SHIFT;
+    for (size_t slot = 1; slot < count; ++slot) {
+        const uint32_t tile = mortonKey(slot) >> TILE_KEY_SHIFT;
+        backwards += tile < previous;
+        previous = tile;
+    }
+    return static_cast<float>(backwards) / static_cast<float>(count - 1);
+}
+
+bool CreatureStore::update(uint64_t tick) {
+    bool due = m_settings.reorderInterval > 0 && tick - m_lastReorder >= m_settings.reorderInterval;
+    if (!due && tick - m_lastCheck >= m_settings.disorderCheckInterval) {
+        m_lastCheck = tick;
+        m_disorder = measureDisorder();
+        due = m_disorder > m_settings.disorderThreshold;
+    }
+    if (!due) return false;
+
+    reorder();
+    m_lastReorder = tick;
+    m_lastCheck = tick;
+    return true;
+}
+
+void CreatureStore::sortKeys() {
+    // LSD radix sort of key << 32 | old slot. Each pass: every worker
+    // counts digits in its band, the counts are prefix-summed digit-major
+    // and band-minor, and every worker scatters its band to the offsets it
+    // was given. The bands are the same in both parallelFor() calls, so
+    // each pass is stable.
+    const size_t count = size();
+    auto& jobs = JobSystem::get();
+    const unsigned workers = jobs.getWorkerCount();
+    m_sortNext.resize(count);
+
+    for (uint32_t shift = 32; shift < 32 + m_keyBits; shift += RADIX_BITS) {
+        m_histograms.assign(static_cast<size_t>(workers) * RADIX, 0);
+        jobs.parallelFor(count, [&](size_t begin, size_t end, unsigned worker) {
+            uint32_t* histogram = m_histograms.data() + static_cast<size_t>(worker) * RADIX;
+            for (size_t i = begin; i < end; ++i) {
+                ++histogram[(m_sort[i] >> shift) & (RADIX - 1)];
+            }
+        }, CREATURE_GRAIN);
+
+        // A digit every key shares leaves the order as it is
+        bool uniform = false;
+        for (uint32_t digit = 0; digit < RADIX && !uniform; ++digit) {
+            size_t total = 0;
+            for (unsigned w = 0; w < workers; ++w) {
+                total += m_histograms[static_cast<size_t>(w) * RADIX + digit];
+            }
+            uniform = total == count;
+        }
+        if (uniform) continue;
+
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < RADIX; ++digit) {
+            for (unsigned w = 0; w < workers; ++w) {
+                uint32_t& bucket = m_histograms[static_cast<size_t>(w) * RADIX + digit];
+                const uint32_t n = bucket;
+                bucket = offset;
+                offset += n;
+            }
+        }
+
+        jobs.parallelFor(count, [&](size_t begin, size_t end, unsigned worker) {
+            uint32_t* offsets = m_histograms.data() + static_cast<size_t>(worker) * RADIX;
+            for (size_t i = begin; i < end; ++i) {
+                m_sortNext[offsets[(m_sort[i] >> shift) & (RADIX - 1)]++] = m_sort[i];
+            }
+        }, CREATURE_GRAIN);
+        m_sort.swap(m_sortNext);
+    }
+}
+
+void CreatureStore::reorder() {
+    const size_t count = size();
+    m_sort.resize(count);
+    m_permutation.resize(count);
+    JobSystem::get().parallelFor(count, [&](size_t begin, size_t end, unsigned) {
+        for (size_t slot = begin; slot < end; ++slot) {
+            m_sort[slot] = static_cast<uint64_t>(mortonKey(slot)) << 32 | slot;
+        }
+    }, CREATURE_GRAIN);
+
+    sortKeys();
+    JobSystem::get().parallelFor(count, [&](size_t begin, size_t end, unsigned) {
+        for (size_t slot = begin; slot < end; ++slot) {
+            m_permutation[slot] = static_cast<uint32_t>(m_sort[slot]);
+        }
+    }, CREATURE_GRAIN);
+
+    gather(m_x, m_permutation, m_floatScratch);
+    gather(m_y, m_permutation, m_floatScratch);
+    gather(m_vx, m_permutation, m_floatScratch);
+    gather(m_vy, m_permutation, m_floatScratch);
+    gather(m_energy, m_permutation, m_floatScratch);
+    gather(m_genome, m_permutation, m_idScratch);
+    gather(m_handleOf, m_permutation, m_idScratch);
+    for (size_t slot = 0; slot < count; ++slot) {
+        m_slotOf[m_handleOf[slot]] = static_cast<uint32_t>(slot);
+    }
+
+    m_disorder = 0.0f;
+    ++m_reorders;
+}
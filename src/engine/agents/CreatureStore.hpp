@@ -0,0 +1,139 @@
+#pragma once
+
+#include "genetics/GenomeStore.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Creatures in structure-of-arrays form, kept in spatial order.
+//
+// Each field is its own dense array indexed by slot, [0, size()). Slots are
+// not stable: despawn() moves the last creature into the freed slot and
+// reorder() permutes everyone. Handles are: a handle names one creature for
+// its whole life and goes stale (isAlive() false) once it despawns.
+//
+// As creatures move, slot order drifts away from position order, and
+// creatures that are neighbours in the world end up far apart in memory.
+// reorder() sorts the slots by the Morton code of each creature's cell with
+// a parallel LSD radix sort, so a creature's neighbours, and the cells of
+// any field it samples, are mostly in cache already. update() reorders
+// every reorderInterval ticks, or sooner when the share of neighbouring
+// slots that step backwards along the Z-curve (by whole 32x32 tiles)
+// passes disorderThreshold.
+//
+// Systems keeping their own per-slot arrays apply getPermutation() after a
+// reorder (AgentLodScheduler::permute() does this for the scheduler).
+// Not thread-safe apart from reorder()'s internal workers.
+class CreatureStore {
+public:
+    using Handle = uint64_t;
+    static constexpr Handle NO_CREATURE = 0;
+
+    struct Settings {
+        uint32_t reorderInterval = 600;      // Ticks between unconditional reorders; 0 = never
+        uint32_t disorderCheckInterval = 32; // Ticks between disorder measurements
+        float disorderThreshold = 0.1f;      // Reorder early above this disorder
+    };
+
+    // Positions are in cells of a width x height world
+    CreatureStore(uint32_t width, uint32_t height);
+    CreatureStore(uint32_t width, uint32_t height, const Settings& settings);
+
+    Handle spawn(float x, float y, GenomeStore::GenomeId genome, float energy);
+    bool despawn(Handle handle);
+    bool isAlive(Handle handle) const;
+
+    // Current slot of a live creature
+    uint32_t slotOf(Handle handle) const { return m_slotOf[indexOf(handle)]; }
+    Handle handleAt(uint32_t slot) const {
+        const uint32_t index = m_handleOf[slot];
+        return makeHandle(index, m_generations[index]);
+    }
+
+    size_t size() const { return m_x.size(); }
+
+    float* getX() { return m_x.data(); }
+    float* getY() { return m_y.data(); }
+    float* getVelocityX() { return m_vx.data(); }
+    float* getVelocityY() { return m_vy.data(); }
+    float* getEnergy() { return m_energy.data(); }
+    GenomeStore::GenomeId* getGenome() { return m_genome.data(); }
+    const float* getX() const { return m_x.data(); }
+    const float* getY() const { return m_y.data(); }
+    const float* getVelocityX() const { return m_vx.data(); }
+    const float* getVelocityY() const { return m_vy.data(); }
+    const float* getEnergy() const { return m_energy.data(); }
+    const GenomeStore::GenomeId* getGenome() const { return m_genome.data(); }
+
+    // Reorder if the interval has passed or disorder is above the threshold.
+    // Returns true if it reordered.
+    bool update(uint64_t tick);
+
+    // Sort slots by Morton code now
+    void reorder();
+
+    // Share of neighbouring slot pairs whose tile steps backwards along the
+    // Z-curve: 0 right after reorder(), about 0.5 for random order
+    float measureDisorder() const;
+    float getDisorder() const { return m_disorder; }
+
+    // Old slot of each new slot, from the last reorder(); size() entries
+    const std::vector<uint32_t>& getPermutation() const { return m_permutation; }
+    uint64_t getReorderCount() const { return m_reorders; }
+
+    // Apply the last reorder's permutation to a per-slot array of the
+    // caller's, using `scratch` as temporary storage
+    template <typename T, typename Alloc>
+    void applyPermutation(std::vector<T, Alloc>& values, std::vector<T, Alloc>& scratch) const {
+        scratch.resize(values.size());
+        for (size_t slot = 0; slot < m_permutation.size(); ++slot) {
+            scratch[slot] = values[m_permutation[slot]];
+        }
+        values.swap(scratch);
+    }
+
+private:
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFFu;
+    static constexpr uint32_t RADIX_BITS = 11;
+    static constexpr uint32_t RADIX = 1u << RADIX_BITS;
+
+    static Handle makeHandle(uint32_t index, uint32_t generation) {
+        return static_cast<uint64_t>(generation) << 32 | (index + 1);
+    }
+    static uint32_t indexOf(Handle handle) { return static_cast<uint32_t>(handle) - 1; }
+
+    uint32_t mortonKey(size_t slot) const;
+    void sortKeys();
+
+    Settings m_settings;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_keyBits;   // Morton bits a cell of this world can set
+
+    // Per slot
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_vx;
+    std::vector<float> m_vy;
+    std::vector<float> m_energy;
+    std::vector<GenomeStore::GenomeId> m_genome;
+    std::vector<uint32_t> m_handleOf;   // Handle index owning the slot
+
+    // Per handle index
+    std::vector<uint32_t> m_slotOf;     // NO_SLOT when free
+    std::vector<uint32_t> m_generations;
+    std::vector<uint32_t> m_freeIndices;
+
+    uint64_t m_lastReorder = 0;
+    uint64_t m_lastCheck = 0;
+    float m_disorder = 0.0f;
+    uint64_t m_reorders = 0;
+
+    // Scratch
+    std::vector<uint64_t> m_sort;       // Morton key << 32 | old slot
+    std::vector<uint64_t> m_sortNext;
+    std::vector<uint32_t> m_permutation;
+    std::vector<uint32_t> m_histograms;   // RADIX per worker
+    std::vector<float> m_floatScratch;
+    std::vector<uint32_t> m_idScratch;
+};
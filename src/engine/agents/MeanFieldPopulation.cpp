@@ -0,0 +1,273 @@
+#include "MeanFieldPopulation.hpp"
+#include "core/JobSystem.hpp"
+#include "field/MipPyramid.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Chunks per job in step()
+constexpr size_t CHUNK_GRAIN = 64;
+
+// Largest per-substep fraction any rule may move, keeping the explicit
+// update positive and stable
+constexpr double MAX_STEP_FRACTION = 0.25;
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+float unitFloat(uint64_t& state) {
+    return static_cast<float>(splitmix64(state) >> 40) * (1.0f / 16777216.0f);
+}
+
+// Chunk column/row holding cell coordinate `v`, clamped to [0, chunks - 1]
+int64_t chunkCoord(float v, uint32_t chunks) {
+    if (!(v > 0.0f)) return 0;  // Also NaN
+    const double c = std::floor(static_cast<double>(v) / MeanFieldPopulation::CHUNK_SIZE);
+    return static_cast<int64_t>(std::min(c, static_cast<double>(chunks - 1)));
+}
+
+int64_t rangeDistance(int64_t c, int64_t lo, int64_t hi) {
+    return c < lo ? lo - c : (c > hi ? c - hi : 0);
+}
+
+} // namespace
+
+MeanFieldPopulation::MeanFieldPopulation(uint32_t width, uint32_t height)
+    : MeanFieldPopulation(width, height, Settings()) {}
+
+MeanFieldPopulation::MeanFieldPopulation(uint32_t width, uint32_t height, const Settings& settings)
+    : m_settings(settings)
+    , m_width(std::max<uint32_t>(1, width))
+    , m_height(std::max<uint32_t>(1, height))
+    , m_chunksX((m_width + CHUNK_SIZE - 1) >> CHUNK_SHIFT)
+    , m_chunksY((m_height + CHUNK_SIZE - 1) >> CHUNK_SHIFT) {
+    m_settings.traitBuckets = std::clamp<uint32_t>(m_settings.traitBuckets, 1, 256);
+    m_settings.capacity = std::max(m_settings.capacity, 1e-6);
+    m_settings.tolerance = std::max(m_settings.tolerance, 1e-6);
+    m_settings.releaseMargin = std::max(m_settings.releaseMargin, m_settings.watchMargin);
+
+    const size_t chunks = getChunkCount();
+    m_modes.assign(chunks, Mode::Individual);
+    m_environment.assign(chunks, 20.0f);
+    m_counts.assign(chunks * m_settings.traitBuckets, 0.0f);
+    m_next.assign(m_counts.size(), 0.0f);
+    m_materializations.assign(chunks, 0);
+
+    const uint32_t buckets = m_settings.traitBuckets;
+    m_optimum.resize(buckets);
+    for (uint32_t b = 0; b < buckets; ++b) {
+        const double trait = (b + 0.5) / buckets;
+        m_optimum[b] = static_cast<float>(m_settings.optimumMin +
+                                          trait * (m_settings.optimumMax - m_settings.optimumMin));
+    }
+
+    // Migration can send a fraction to each of four neighbours at once
+    const double fastest = std::max({m_settings.birthRate, m_settings.deathRate,
+                                     m_settings.mutationRate, 4.0 * m_settings.migrationRate});
+    m_maxStep = fastest > 0.0 ? MAX_STEP_FRACTION / fastest : 1e9;
+}
+
+uint32_t MeanFieldPopulation::watchDistance(uint32_t cx, uint32_t cy) const {
+    const int64_t x = cx;
+    const int64_t y = cy;
+    int64_t best = std::max(
+        rangeDistance(x, chunkCoord(m_viewport.minX, m_chunksX), chunkCoord(m_viewport.maxX, m_chunksX)),
+        rangeDistance(y, chunkCoord(m_viewport.minY, m_chunksY), chunkCoord(m_viewport.maxY, m_chunksY)));
+    for (const Probe& probe : m_probes) {
+        const int64_t d = std::max(
+            rangeDistance(x, chunkCoord(probe.x - probe.radius, m_chunksX),
+                          chunkCoord(probe.x + probe.radius, m_chunksX)),
+            rangeDistance(y, chunkCoord(probe.y - probe.radius, m_chunksY),
+                          chunkCoord(probe.y + probe.radius, m_chunksY)));
+        best = std::min(best, d);
+    }
+    return static_cast<uint32_t>(best);
+}
+
+void MeanFieldPopulation::planTransitions(std::vector<uint32_t>& toAggregate,
+                                          std::vector<uint32_t>& toMaterialize) const {
+    toAggregate.clear();
+    toMaterialize.clear();
+    // Between watchMargin and releaseMargin chunks keep whatever mode they
+    // have, so a viewport wobbling on a chunk edge does not convert back and forth
+    for (uint32_t cy = 0; cy < m_chunksY; ++cy) {
+        for (uint32_t cx = 0; cx < m_chunksX; ++cx) {
+            const uint32_t chunk = cy * m_chunksX + cx;
+            const uint32_t distance = watchDistance(cx, cy);
+            if (m_modes[chunk] == Mode::Aggregate) {
+                if (distance <= m_settings.watchMargin) toMaterialize.push_back(chunk);
+            } else if (distance > m_settings.releaseMargin) {
+                toAggregate.push_back(chunk);
+            }
+        }
+    }
+}
+
+void MeanFieldPopulation::aggregate(uint32_t chunk, const float* traits, size_t count) {
+    const uint32_t buckets = m_settings.traitBuckets;
+    float* counts = m_counts.data() + bucketIndex(chunk, 0);
+    std::fill(counts, counts + buckets, 0.0f);
+    for (size_t i = 0; i < count; ++i) {
+        const float t = std::clamp(traits[i], 0.0f, 1.0f);
+        const uint32_t b = std::min(static_cast<uint32_t>(t * buckets), buckets - 1);
+        counts[b] += 1.0f;
+    }
+    m_modes[chunk] = Mode::Aggregate;
+}
+
+size_t MeanFieldPopulation::materialize(uint32_t chunk, std::vector<Individual>& out) {
+    const uint32_t buckets = m_settings.traitBuckets;
+    const uint32_t cx = chunk % m_chunksX;
+    const uint32_t cy = chunk / m_chunksX;
+    const float x0 = static_cast<float>(cx << CHUNK_SHIFT);
+    const float y0 = static_cast<float>(cy << CHUNK_SHIFT);
+    const float spanX = static_cast<float>(std::min(CHUNK_SIZE, m_width - (cx << CHUNK_SHIFT)));
+    const float spanY = static_cast<float>(std::min(CHUNK_SIZE, m_height - (cy << CHUNK_SHIFT)));
+
+    uint64_t rng = (static_cast<uint64_t>(chunk) << 32) | m_materializations[chunk]++;
+    float* counts = m_counts.data() + bucketIndex(chunk, 0);
+    const size_t before = out.size();
+    for (uint32_t b = 0; b < buckets; ++b) {
+        const float n = std::max(counts[b], 0.0f);
+        const float whole = std::floor(n);
+        const size_t k = static_cast<size_t>(whole) + (unitFloat(rng) < n - whole ? 1 : 0);
+        for (size_t i = 0; i < k; ++i) {
+            Individual individual;
+            individual.x = x0 + unitFloat(rng) * spanX;
+            individual.y = y0 + unitFloat(rng) * spanY;
+            individual.trait = std::min((b + unitFloat(rng)) / buckets, 0.99999994f);
+            out.push_back(individual);
+        }
+        counts[b] = 0.0f;
+    }
+    m_modes[chunk] = Mode::Individual;
+    return out.size() - before;
+}
+
+void MeanFieldPopulation::setEnvironment(const MipPyramid& temperature) {
+    if (temperature.levelCount() == 0) return;
+    const size_t level = std::min<size_t>(CHUNK_SHIFT, temperature.levelCount() - 1);
+    const uint32_t w = std::min(m_chunksX, temperature.levelWidth(level));
+    const uint32_t h = std::min(m_chunksY, temperature.levelHeight(level));
+    for (uint32_t cy = 0; cy < h; ++cy) {
+        for (uint32_t cx = 0; cx < w; ++cx) {
+            const uint32_t cells = temperature.cellCount(level, cx, cy);
+            if (cells == 0) continue;
+            m_environment[cy * m_chunksX + cx] = static_cast<float>(temperature.at(level, cx, cy) / cells);
+        }
+    }
+}
+
+void MeanFieldPopulation::step(double ticks) {
+    if (!(ticks > 0.0)) return;
+    const auto substeps = static_cast<uint32_t>(std::ceil(ticks / m_maxStep));
+    const double dt = ticks / substeps;
+    for (uint32_t i = 0; i < substeps; ++i) {
+        stepLocal(dt);
+        if (m_settings.migrationRate > 0.0) stepMigration(dt);
+    }
+}
+
+void MeanFieldPopulation::stepLocal(double dt) {
+    const uint32_t buckets = m_settings.traitBuckets;
+    const double invTolerance = 1.0 / m_settings.tolerance;
+    const double invCapacity = 1.0 / m_settings.capacity;
+    const double birth = m_settings.birthRate * dt;
+    const double death = m_settings.deathRate * dt;
+    const double drift = 0.5 * m_settings.mutationRate * dt;  // To each neighbouring bucket
+
+    JobSystem::get().parallelFor(getChunkCount(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            if (m_modes[chunk] != Mode::Aggregate) continue;
+            float* counts = m_counts.data() + bucketIndex(static_cast<uint32_t>(chunk), 0);
+
+            double total = 0.0;
+            for (uint32_t b = 0; b < buckets; ++b) {
+                total += counts[b];
+            }
+            if (total <= 0.0) continue;
+
+            const double crowding = std::max(0.0, 1.0 - total * invCapacity);
+            const double temperature = m_environment[chunk];
+            for (uint32_t b = 0; b < buckets; ++b) {
+                const double z = (temperature - m_optimum[b]) * invTolerance;
+                const double growth = birth * std::exp(-z * z) * crowding - death;
+                counts[b] = static_cast<float>(counts[b] * (1.0 + growth));
+            }
+
+            // Mutation: each bucket leaks to its neighbours; the ends keep
+            // the half that would fall off the trait range
+            if (drift > 0.0 && buckets > 1) {
+                float carry = 0.0f;  // Drift from bucket b - 1 into b
+                for (uint32_t b = 0; b < buckets; ++b) {
+                    const float n = counts[b];
+                    const float up = b + 1 < buckets ? static_cast<float>(n * drift) : 0.0f;
+                    const float down = b > 0 ? static_cast<float>(n * drift) : 0.0f;
+                    if (b > 0) counts[b - 1] += down;
+                    counts[b] = n - up - down + carry;
+                    carry = up;
+                }
+            }
+        }
+    }, CHUNK_GRAIN);
+}
+
+void MeanFieldPopulation::stepMigration(double dt) {
+    const uint32_t buckets = m_settings.traitBuckets;
+    const float rate = static_cast<float>(m_settings.migrationRate * dt);
+
+    // Each chunk gathers from its neighbours into m_next, so rows can run
+    // in parallel without sharing writes
+    JobSystem::get().parallelFor(m_chunksY, [&](size_t rowBegin, size_t rowEnd, unsigned) {
+        for (size_t cy = rowBegin; cy < rowEnd; ++cy) {
+            for (uint32_t cx = 0; cx < m_chunksX; ++cx) {
+                const uint32_t chunk = static_cast<uint32_t>(cy) * m_chunksX + cx;
+                const float* own = m_counts.data() + bucketIndex(chunk, 0);
+                float* next = m_next.data() + bucketIndex(chunk, 0);
+                std::copy(own, own + buckets, next);
+                if (m_modes[chunk] != Mode::Aggregate) continue;
+
+                uint32_t neighbours[4];
+                uint32_t neighbourCount = 0;
+                if (cx > 0) neighbours[neighbourCount++] = chunk - 1;
+                if (cx + 1 < m_chunksX) neighbours[neighbourCount++] = chunk + 1;
+                if (cy > 0) neighbours[neighbourCount++] = chunk - m_chunksX;
+                if (cy + 1 < m_chunksY) neighbours[neighbourCount++] = chunk + m_chunksX;
+
+                // Only aggregated chunks exchange; creatures entering a
+                // watched chunk would have to be materialized one by one
+                for (uint32_t k = 0; k < neighbourCount; ++k) {
+                    const uint32_t other = neighbours[k];
+                    if (m_modes[other] != Mode::Aggregate) continue;
+                    const float* theirs = m_counts.data() + bucketIndex(other, 0);
+                    for (uint32_t b = 0; b < buckets; ++b) {
+                        next[b] += rate * (theirs[b] - own[b]);
+                    }
+                }
+            }
+        }
+    }, std::max<size_t>(1, CHUNK_GRAIN / std::max<uint32_t>(1, m_chunksX)));
+    m_counts.swap(m_next);
+}
+
+double MeanFieldPopulation::getPopulation(uint32_t chunk) const {
+    const float* counts = getCounts(chunk);
+    double total = 0.0;
+    for (uint32_t b = 0; b < m_settings.traitBuckets; ++b) {
+        total += counts[b];
+    }
+    return total;
+}
+
+double MeanFieldPopulation::getAggregatedPopulation() const {
+    double total = 0.0;
+    for (uint32_t chunk = 0; chunk < getChunkCount(); ++chunk) {
+        if (m_modes[chunk] == Mode::Aggregate) total += getPopulation(chunk);
+    }
+    return total;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "AgentLodScheduler.hpp"
+#include "field/GridLayout.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class MipPyramid;
+
+// Population of unwatched chunks kept as distributions instead of agents.
+//
+// The world is split into 32x32-cell chunks (the tile size). A chunk is
+// either Individual, with its creatures simulated one by one by their store,
+// or Aggregate: a histogram of how many creatures carry each value of one
+// trait, their preferred temperature, bucketed over [0, 1). step() evolves
+// the histograms with mean-field rules, which cost the same however many
+// creatures a chunk holds:
+//
+//   births   n_b * birthRate * bell(T - optimum_b) * (1 - N / capacity)
+//   deaths   n_b * deathRate
+//   mutation a fraction of each bucket drifts to the neighbouring buckets
+//   movement a fraction of each chunk moves to each aggregated neighbour
+//
+// where T is the chunk's mean temperature (setEnvironment()) and N its
+// total population.
+//
+// Chunks inside the viewport (plus watchMargin chunks) or an analysis
+// probe's radius must be Individual; chunks further than releaseMargin
+// chunks out may be aggregated. planTransitions() lists what should change
+// and the owner of the creatures calls aggregate() / materialize() to hand
+// them over, so huge worlds cost in proportion to the watched area.
+class MeanFieldPopulation {
+public:
+    static constexpr uint32_t CHUNK_SHIFT = GridLayout::TILE_SHIFT;
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_SHIFT;
+
+    enum class Mode : uint8_t {
+        Individual,
+        Aggregate
+    };
+
+    struct Settings {
+        uint32_t traitBuckets = 16;
+        double birthRate = 0.05;        // Per tick, at the preferred temperature, in an empty chunk
+        double deathRate = 0.02;        // Per tick
+        double capacity = 200.0;        // Creatures per chunk at which births stop
+        double optimumMin = -10.0;      // Preferred temperature of trait 0 (Celsius)
+        double optimumMax = 50.0;       // ... and of trait 1
+        double tolerance = 15.0;        // Width of the birth-rate bell (Celsius)
+        double mutationRate = 0.01;     // Fraction per tick drifting to neighbouring buckets
+        double migrationRate = 0.005;   // Fraction per tick moving to each aggregated neighbour
+        uint32_t watchMargin = 1;       // Chunks around the viewport kept Individual
+        uint32_t releaseMargin = 3;     // Chunks beyond which Individual chunks are aggregated
+    };
+
+    using Viewport = AgentLodScheduler::Viewport;
+
+    struct Probe {
+        float x;        // Cells
+        float y;
+        float radius;
+    };
+
+    // One materialized creature
+    struct Individual {
+        float x;        // Cells
+        float y;
+        float trait;    // [0, 1)
+    };
+
+    MeanFieldPopulation(uint32_t width, uint32_t height);
+    MeanFieldPopulation(uint32_t width, uint32_t height, const Settings& settings);
+
+    uint32_t getChunksX() const { return m_chunksX; }
+    uint32_t getChunksY() const { return m_chunksY; }
+    uint32_t getChunkCount() const { return m_chunksX * m_chunksY; }
+    uint32_t chunkAt(uint32_t x, uint32_t y) const {
+        return (y >> CHUNK_SHIFT) * m_chunksX + (x >> CHUNK_SHIFT);
+    }
+
+    Mode getMode(uint32_t chunk) const { return m_modes[chunk]; }
+    const Settings& getSettings() const { return m_settings; }
+
+    void setViewport(const Viewport& viewport) { m_viewport = viewport; }
+    void setProbes(std::vector<Probe> probes) { m_probes = std::move(probes); }
+
+    // Chunks to hand over: watched Aggregate chunks to materialize, and
+    // Individual chunks beyond the release margin to aggregate
+    void planTransitions(std::vector<uint32_t>& toAggregate, std::vector<uint32_t>& toMaterialize) const;
+
+    // Take over a chunk's creatures as a distribution of `traits` (one per
+    // creature, [0, 1)); the caller then removes the creatures
+    void aggregate(uint32_t chunk, const float* traits, size_t count);
+
+    // Turn a chunk's distribution back into creatures, appended to `out`
+    // with positions spread over the chunk. Fractional counts are rounded
+    // stochastically from a seed fixed by the chunk and the number of
+    // materializations so far, so replays match. Returns how many.
+    size_t materialize(uint32_t chunk, std::vector<Individual>& out);
+
+    // Mean temperature per chunk from a pyramid of the temperature field
+    // (level CHUNK_SHIFT holds one node per chunk)
+    void setEnvironment(const MipPyramid& temperature);
+    void setEnvironment(uint32_t chunk, float temperature) { m_environment[chunk] = temperature; }
+
+    // Advance every Aggregate chunk by `ticks` ticks
+    void step(double ticks);
+
+    const float* getCounts(uint32_t chunk) const { return m_counts.data() + bucketIndex(chunk, 0); }
+    double getPopulation(uint32_t chunk) const;
+    double getAggregatedPopulation() const;
+
+private:
+    size_t bucketIndex(uint32_t chunk, uint32_t bucket) const {
+        return static_cast<size_t>(chunk) * m_settings.traitBuckets + bucket;
+    }
+
+    // Chebyshev distance in chunks from the watched area (viewport or
+    // probes), 0 inside it
+    uint32_t watchDistance(uint32_t cx, uint32_t cy) const;
+
+    void stepLocal(double dt);
+    void stepMigration(double dt);
+
+    Settings m_settings;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_chunksX;
+    uint32_t m_chunksY;
+
+    Viewport m_viewport;
+    std::vector<Probe> m_probes;
+
+    std::vector<Mode> m_modes;
+    std::vector<float> m_environment;   // Per chunk, Celsius
+    std::vector<float> m_counts;        // Per chunk, traitBuckets each
+    std::vector<float> m_next;          // step() scratch, same shape
+    std::vector<float> m_optimum;       // Preferred temperature per bucket
+    double m_maxStep = 1.0;             // Longest substep in ticks
+    std::vector<uint32_t> m_materializations;  // Per chunk, seeds materialize()
+};
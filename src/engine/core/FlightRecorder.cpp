@@ -0,0 +1,328 @@
+#include "FlightRecorder.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define FLIGHT_RECORDER_POSIX 1
+#include <csignal>
+#include <exception>
+#include <fcntl.h>
+#include <memory>
+#include <unistd.h>
+#endif
+
+namespace FlightRecorder {
+
+namespace {
+
+static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+// Sequence 0 marks a slot never written or being written
+struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence{0};
+    Event event;
+};
+
+Slot s_slots[CAPACITY];
+std::atomic<uint64_t> s_next{0};
+std::atomic<uint64_t> s_tick{0};
+
+Event& beginSlot(uint64_t& sequence) {
+    sequence = s_next.fetch_add(1, std::memory_order_relaxed) + 1;
+    Slot& slot = s_slots[sequence & (CAPACITY - 1)];
+    // Seqlock writer: the zeroed sequence must be visible to other threads
+    // before any payload byte is, or a dump could pair new bytes with the
+    // old sequence
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return slot.event;
+}
+
+void commitSlot(uint64_t sequence) {
+    s_slots[sequence & (CAPACITY - 1)].sequence.store(sequence, std::memory_order_release);
+}
+
+const char* typeName(EventType type) {
+    switch (type) {
+        case EventType::Tick: return "tick";
+        case EventType::Command: return "command";
+        case EventType::Save: return "save";
+        case EventType::Load: return "load";
+        case EventType::Allocation: return "alloc";
+        case EventType::Warning: return "warning";
+        case EventType::Error: return "error";
+        case EventType::Marker: return "marker";
+    }
+    return "?";
+}
+
+// Bounded appender; snprintf is not async-signal-safe
+struct Writer {
+    char* out;
+    size_t capacity;
+    size_t length = 0;
+
+    void put(const char* s) {
+        while (*s && length + 1 < capacity) out[length++] = *s++;
+    }
+
+    void put(uint64_t v) {
+        char digits[20];
+        size_t n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v);
+        while (n && length + 1 < capacity) out[length++] = digits[--n];
+    }
+
+    // Three decimals is plenty for temperatures and progress
+    void put(double v) {
+        if (v != v) {
+            put("nan");
+            return;
+        }
+        if (v < 0) {
+            put("-");
+            v = -v;
+        }
+        if (v >= 1e18) {
+            put("inf");
+            return;
+        }
+        const uint64_t milli = static_cast<uint64_t>(v * 1000.0 + 0.5);
+        put(milli / 1000);
+        put(".");
+        const uint64_t frac = milli % 1000;
+        if (frac < 100) put("0");
+        if (frac < 10) put("0");
+        put(frac);
+    }
+
+    void finish() {
+        if (capacity) out[length] = '\0';
+    }
+};
+
+} // namespace
+
+void record(EventType type, const char* label, uint64_t a, double b) {
+    uint64_t sequence;
+    Event& e = beginSlot(sequence);
+    e.tick = s_tick.load(std::memory_order_relaxed);
+    e.label = label;
+    e.a = a;
+    e.b = b;
+    e.type = type;
+    e.text[0] = '\0';
+    commitSlot(sequence);
+}
+
+void recordText(EventType type, const char* label, const char* text) {
+    uint64_t sequence;
+    Event& e = beginSlot(sequence);
+    e.tick = s_tick.load(std::memory_order_relaxed);
+    e.label = label;
+    e.a = 0;
+    e.b = 0.0;
+    e.type = type;
+    size_t n = 0;
+    for (; text && text[n] && n + 1 < TEXT_SIZE; ++n) {
+        e.text[n] = text[n];
+    }
+    e.text[n] = '\0';
+    commitSlot(sequence);
+}
+
+void recordTick(const char* label, uint64_t value) {
+    s_tick.fetch_add(1, std::memory_order_relaxed);
+    record(EventType::Tick, label, value);
+}
+
+size_t snapshot(Event* out, size_t capacity) {
+    const uint64_t last = s_next.load(std::memory_order_acquire);
+    const uint64_t first = last > CAPACITY ? last - CAPACITY + 1 : 1;
+    size_t count = 0;
+    for (uint64_t sequence = first; sequence <= last && count < capacity; ++sequence) {
+        const Slot& slot = s_slots[sequence & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != sequence) continue;
+        // Copy, then fence before re-checking, so the copy cannot be
+        // reordered after the second read of the sequence
+        out[count] = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;  // Overwritten meanwhile
+        ++count;
+    }
+    return count;
+}
+
+size_t format(char* out, size_t capacity, const char* reason) {
+    Writer w{out, capacity};
+    w.put("=== Flight recorder (");
+    w.put(reason ? reason : "dump");
+    w.put("), ");
+    w.put(s_next.load(std::memory_order_relaxed));
+    w.put(" events recorded, tick ");
+    w.put(s_tick.load(std::memory_order_relaxed));
+    w.put(" ===\n");
+
+    // Walk the ring in place: a snapshot buffer of CAPACITY events would not
+    // fit on a signal handler's stack
+    const uint64_t last = s_next.load(std::memory_order_acquire);
+    const uint64_t first = last > CAPACITY ? last - CAPACITY + 1 : 1;
+    for (uint64_t sequence = first; sequence <= last; ++sequence) {
+        const Slot& slot = s_slots[sequence & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != sequence) continue;
+        const Event e = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+        w.put("#");
+        w.put(sequence);
+        w.put(" t");
+        w.put(e.tick);
+        w.put(" ");
+        w.put(typeName(e.type));
+        w.put(" ");
+        w.put(e.label ? e.label : "");
+        if (e.text[0]) {
+            w.put(" \"");
+            w.put(e.text);
+            w.put("\"");
+        } else {
+            w.put(" a=");
+            w.put(e.a);
+            w.put(" b=");
+            w.put(e.b);
+        }
+        w.put("\n");
+    }
+    w.finish();
+    return w.length;
+}
+
+namespace {
+
+// Big enough for a full ring; static so a dump needs neither the heap nor
+// much stack
+char s_dumpBuffer[CAPACITY * 96];
+std::atomic_flag s_bufferBusy = ATOMIC_FLAG_INIT;
+
+} // namespace
+
+const char* dumpText(const char* reason) {
+    if (s_bufferBusy.test_and_set(std::memory_order_acquire)) return "";
+    format(s_dumpBuffer, sizeof(s_dumpBuffer), reason);
+    s_bufferBusy.clear(std::memory_order_release);
+    return s_dumpBuffer;
+}
+
+#ifdef FLIGHT_RECORDER_POSIX
+
+namespace {
+
+std::atomic<bool> s_dumping{false};
+int s_dumpFile = -1;
+
+const int s_fatalSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+constexpr size_t ALT_STACK_SIZE = 64 * 1024;
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n <= 0) return;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+void crashDump(const char* reason) {
+    // First crash only: abort() inside terminate raises SIGABRT again
+    if (s_dumping.exchange(true)) return;
+    dumpTo(STDERR_FILENO, reason);
+    if (s_dumpFile >= 0) {
+        dumpTo(s_dumpFile, reason);
+        ::fsync(s_dumpFile);
+    }
+}
+
+void onFatalSignal(int signal) {
+    const char* reason = "fatal signal";
+    switch (signal) {
+        case SIGSEGV: reason = "SIGSEGV"; break;
+        case SIGBUS: reason = "SIGBUS"; break;
+        case SIGFPE: reason = "SIGFPE"; break;
+        case SIGILL: reason = "SIGILL"; break;
+        case SIGABRT: reason = "SIGABRT"; break;
+    }
+    crashDump(reason);
+
+    // Re-raise with the default action so the process still dies (and
+    // dumps core) as it would have
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
+void onTerminate() {
+    crashDump("std::terminate");
+    std::signal(SIGABRT, SIG_DFL);
+    std::abort();
+}
+
+} // namespace
+
+void dumpTo(int fd, const char* reason) {
+    if (s_bufferBusy.test_and_set(std::memory_order_acquire)) return;
+    const size_t length = format(s_dumpBuffer, sizeof(s_dumpBuffer), reason);
+    writeAll(fd, s_dumpBuffer, length);
+    s_bufferBusy.clear(std::memory_order_release);
+}
+
+void installThreadStack() {
+    // Freed when the thread exits, which also ends its use as a signal stack
+    thread_local std::unique_ptr<char[]> t_altStack;
+    if (t_altStack) return;
+
+    // Keep a stack someone else already set up (sanitizers give every thread
+    // one, and unmap it themselves on exit)
+    stack_t current = {};
+    if (::sigaltstack(nullptr, &current) == 0 && !(current.ss_flags & SS_DISABLE)) return;
+
+    t_altStack.reset(new char[ALT_STACK_SIZE]);
+    stack_t stack = {};
+    stack.ss_sp = t_altStack.get();
+    stack.ss_size = ALT_STACK_SIZE;
+    ::sigaltstack(&stack, nullptr);
+}
+
+void installCrashHandlers(const char* path) {
+    if (path && s_dumpFile < 0) {
+        s_dumpFile = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    // Handlers run on their own stack so stack overflows still dump. The
+    // alternate stack is per thread; JobSystem workers set up theirs with
+    // installThreadStack().
+    installThreadStack();
+
+    struct sigaction action = {};
+    action.sa_handler = onFatalSignal;
+    action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    for (int signal : s_fatalSignals) {
+        ::sigaction(signal, &action, nullptr);
+    }
+    std::set_terminate(onTerminate);
+}
+
+#else
+
+void dumpTo(int, const char*) {}
+void installThreadStack() {}
+void installCrashHandlers(const char*) {}
+
+#endif
+
+} // namespace FlightRecorder
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Always-on ring of the most recent engine events, for post-mortems.
+//
+// Recording is one atomic increment plus a 64-byte store into a fixed,
+// statically allocated ring: no locks, no allocation and no clock read, so
+// it stays enabled in release builds. Events are stamped with the current
+// tick (recordTick) rather than a time.
+//
+// Each slot carries a sequence number written last, so a dump taken while
+// other threads are recording skips slots caught mid-write instead of
+// printing torn events. Dumping never allocates and formats with plain
+// integer code, so it is safe from a signal handler.
+//
+// Dumped on fatal signals and std::terminate once installCrashHandlers()
+// has run (native), and on WASM aborts by the JS loader
+// (flight_recorder_dump, see js/utils/WasmManager.js).
+namespace FlightRecorder {
+
+constexpr size_t CAPACITY = 4096;  // Power of two
+constexpr size_t TEXT_SIZE = 22;
+
+enum class EventType : uint16_t {
+    Tick,
+    Command,
+    Save,
+    Load,
+    Allocation,
+    Warning,
+    Error,
+    Marker
+};
+
+struct Event {
+    uint64_t tick;
+    const char* label;       // Must be a string literal or otherwise static
+    uint64_t a;              // Integer payload (ids, sizes, coordinates)
+    double b;                // Real payload (temperatures, progress)
+    EventType type;
+    char text[TEXT_SIZE];    // Truncated message for Warning / Error
+};
+
+void record(EventType type, const char* label, uint64_t a = 0, double b = 0.0);
+
+// As record(), also copying the first TEXT_SIZE - 1 bytes of `text`
+void recordText(EventType type, const char* label, const char* text);
+
+// Advance the tick stamped on later events and record a Tick event
+void recordTick(const char* label, uint64_t value = 0);
+
+// Events still in the ring, oldest first; returns how many were copied
+size_t snapshot(Event* out, size_t capacity);
+
+// Human-readable dump, oldest event first. format() writes at most
+// `capacity` bytes including the terminating NUL and returns the length.
+size_t format(char* out, size_t capacity, const char* reason);
+
+// format() into a static buffer, for callers that must not allocate (the
+// WASM abort path). The text stays valid until the next dump; returns ""
+// if another dump is in progress.
+const char* dumpText(const char* reason);
+
+// Write the dump to a file descriptor (async-signal-safe)
+void dumpTo(int fd, const char* reason);
+
+// Dump to stderr, and to `path` if given, on SIGSEGV, SIGBUS, SIGFPE, SIGILL,
+// SIGABRT and std::terminate, then carry on with the default action. No-op
+// on WASM. Also sets up the calling thread's alternate signal stack.
+void installCrashHandlers(const char* path = nullptr);
+
+// Give the calling thread an alternate signal stack, so a stack overflow on
+// it still dumps. Signal stacks are per thread: every long-lived thread
+// that may overflow calls this once (JobSystem workers do). No-op on WASM.
+void installThreadStack();
+
+} // namespace FlightRecorder
@@ -0,0 +1,138 @@
+#include "JobSystem.hpp"
+#include "FlightRecorder.hpp"
+#include <algorithm>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <pthread.h>
+#include <sched.h>
+#define JOB_SYSTEM_PIN_THREADS
+#endif
+
+namespace {
+
+// Set while a thread is running a band, so nested parallelFor calls run
+// inline instead of deadlocking on the dispatch mutex
+thread_local bool t_insideJob = false;
+
+unsigned defaultWorkerCount() {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    return 1;
+#else
+    return std::max(1u, std::thread::hardware_concurrency());
+#endif
+}
+
+// Pin the calling thread to the worker-th CPU the process may run on, so
+// the scheduler cannot move it off the node its bands first touched.
+// Worker 0 (the caller) is never pinned, leaving the first CPU to it.
+void pinToCpu(unsigned worker) {
+#ifdef JOB_SYSTEM_PIN_THREADS
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+    const int count = CPU_COUNT(&allowed);
+    if (count <= 1) return;
+
+    int skip = static_cast<int>(worker % static_cast<unsigned>(count));
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed) || skip-- > 0) continue;
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+        return;
+    }
+#else
+    (void)worker;
+#endif
+}
+
+} // namespace
+
+JobSystem& JobSystem::get() {
+    static JobSystem instance(defaultWorkerCount());
+    return instance;
+}
+
+JobSystem::JobSystem(unsigned workerCount)
+    : m_workerCount(std::max(1u, workerCount)) {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    m_workerCount = 1;
+#endif
+    for (unsigned i = 1; i < m_workerCount; ++i) {
+        m_threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void JobSystem::parallelFor(size_t count, const RangeFn& fn, size_t minGrain) {
+    if (count == 0) return;
+
+    const size_t grain = std::max<size_t>(1, minGrain);
+    const unsigned bands = static_cast<unsigned>(
+        std::min<size_t>(m_workerCount, (count + grain - 1) / grain));
+
+    if (bands <= 1 || t_insideJob) {
+        fn(0, count, 0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fn = &fn;
+        m_count = count;
+        m_bands = bands;
+        m_pending = bands - 1;
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    // The caller is worker 0
+    t_insideJob = true;
+    fn(bandBegin(count, bands, 0), bandBegin(count, bands, 1), 0);
+    t_insideJob = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    m_fn = nullptr;
+}
+
+void JobSystem::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    t_insideJob = true;
+    FlightRecorder::installThreadStack();
+    pinToCpu(worker);
+    for (;;) {
+        const RangeFn* fn;
+        size_t count;
+        unsigned bands;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+            fn = m_fn;
+            count = m_count;
+            bands = m_bands;
+        }
+
+        if (worker >= bands) continue;
+
+        (*fn)(bandBegin(count, bands, worker), bandBegin(count, bands, worker + 1), worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0) {
+            m_done.notify_one();
+        }
+    }
+}
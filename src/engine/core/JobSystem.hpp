@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads for data-parallel engine passes.
+//
+// parallelFor() splits [0, count) into one contiguous band per worker and
+// blocks until every band is done. The split is static: band i always runs on
+// worker i (the calling thread is worker 0), so memory a band touches first
+// stays local to the thread that keeps updating it. On native Linux workers
+// 1..n-1 are pinned to one CPU each so the OS cannot migrate them off that
+// memory's node; the caller is not pinned, so band 0 keeps its placement
+// only as long as the scheduler leaves the caller where it is.
+//
+// Builds without thread support (plain WASM) get a single worker and every
+// call runs inline on the caller.
+class JobSystem {
+public:
+    using RangeFn = std::function<void(size_t begin, size_t end, unsigned worker)>;
+
+    // Process-wide pool sized to the hardware concurrency
+    static JobSystem& get();
+
+    explicit JobSystem(unsigned workerCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Number of workers including the calling thread
+    unsigned getWorkerCount() const { return m_workerCount; }
+
+    // Run fn over [0, count). Fewer than minGrain items per band uses fewer
+    // bands; a single band runs inline.
+    void parallelFor(size_t count, const RangeFn& fn, size_t minGrain = 1);
+
+    // Band boundaries parallelFor() uses for `bands` bands over [0, count)
+    static size_t bandBegin(size_t count, unsigned bands, unsigned band) {
+        return count * band / bands;
+    }
+
+private:
+    void workerLoop(unsigned worker);
+
+    unsigned m_workerCount;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_dispatchMutex;  // One parallelFor at a time
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const RangeFn* m_fn = nullptr;
+    size_t m_count = 0;
+    unsigned m_bands = 0;
+    unsigned m_pending = 0;
+    uint64_t m_generation = 0;
+    bool m_stop = false;
+};
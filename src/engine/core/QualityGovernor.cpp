@@ -0,0 +1,117 @@
+#include "QualityGovernor.hpp"
+#include "FlightRecorder.hpp"
+#include "Logging.hpp"
+#include <algorithm>
+#include <string>
+
+std::vector<QualityGovernor::Level> QualityGovernor::defaultLadder() {
+    //       overlay stats substeps agents
+    return {
+        {1,  1,  1, 0},
+        {2,  1,  1, 0},
+        {2,  8,  1, 0},
+        {4,  8,  2, 0},
+        {4, 16,  2, 1},
+        {8, 30,  4, 2}
+    };
+}
+
+QualityGovernor::QualityGovernor()
+    : QualityGovernor(defaultLadder(), Settings()) {}
+
+QualityGovernor::QualityGovernor(std::vector<Level> ladder, const Settings& settings)
+    : m_settings(settings) {
+    m_settings.degradeFrames = std::max<uint32_t>(1, m_settings.degradeFrames);
+    m_settings.recoverFrames = std::max<uint32_t>(1, m_settings.recoverFrames);
+    m_settings.maxRecoverFrames = std::max(m_settings.recoverFrames, m_settings.maxRecoverFrames);
+    m_settings.smoothing = std::clamp(m_settings.smoothing, 0.01, 1.0);
+    setLadder(std::move(ladder));
+}
+
+void QualityGovernor::addCost(Stage stage, double milliseconds) {
+    m_costs[static_cast<size_t>(stage)] += std::max(0.0, milliseconds);
+}
+
+bool QualityGovernor::endFrame() {
+    double total = 0.0;
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i) {
+        total += m_costs[i];
+        m_lastCosts[i] = m_costs[i];
+        m_costs[i] = 0.0;
+    }
+
+    // Seed the average from the first frame at a level: the previous level's
+    // costs say little about this one's
+    m_average = m_hasAverage ? m_average + m_settings.smoothing * (total - m_average) : total;
+    m_hasAverage = true;
+    ++m_framesAtLevel;
+
+    // A level that has held for a long while has proved itself: forget any
+    // backoff from earlier failed attempts at it
+    if (m_framesAtLevel == m_settings.maxRecoverFrames) {
+        m_recoverFrames[m_level] = m_settings.recoverFrames;
+    }
+
+    if (!m_enabled) return false;
+
+    const double budget = m_settings.budgetMs;
+    m_overFrames = m_average > budget ? m_overFrames + 1 : 0;
+    m_underFrames = m_average < budget * m_settings.recoverRatio ? m_underFrames + 1 : 0;
+
+    if (m_overFrames >= m_settings.degradeFrames && m_level + 1 < m_ladder.size()) {
+        // Overran soon after quality was raised to this level: back off
+        // before trying it again
+        uint32_t& wait = m_recoverFrames[m_level];
+        if (m_raised && m_framesAtLevel < wait) {
+            wait = std::min(wait * 2, m_settings.maxRecoverFrames);
+        }
+        moveTo(m_level + 1);
+        return true;
+    }
+    if (m_level > 0 && m_underFrames >= m_recoverFrames[m_level - 1]) {
+        moveTo(m_level - 1);
+        return true;
+    }
+    return false;
+}
+
+void QualityGovernor::setBudget(double milliseconds) {
+    m_settings.budgetMs = std::max(0.1, milliseconds);
+    m_overFrames = 0;
+    m_underFrames = 0;
+}
+
+void QualityGovernor::setLadder(std::vector<Level> ladder) {
+    if (ladder.empty()) {
+        ladder.push_back(Level());
+    }
+    for (Level& level : ladder) {
+        level.overlayStride = std::max<uint32_t>(1, level.overlayStride);
+        level.statsInterval = std::max<uint32_t>(1, level.statsInterval);
+        level.substeps = std::max<uint32_t>(1, level.substeps);
+    }
+    m_ladder = std::move(ladder);
+    m_raised = false;
+    m_recoverFrames.assign(m_ladder.size(), m_settings.recoverFrames);
+    m_level = std::min(m_level, m_ladder.size() - 1);
+    m_hasAverage = false;
+}
+
+void QualityGovernor::setLevel(size_t level) {
+    moveTo(std::min(level, m_ladder.size() - 1));
+}
+
+void QualityGovernor::moveTo(size_t level) {
+    if (level != m_level) {
+        FlightRecorder::record(FlightRecorder::EventType::Marker, "quality.level", level, m_average);
+        LOG_INFO("Quality level " + std::to_string(m_level) + " -> " + std::to_string(level) +
+                 " (frame cost " + std::to_string(m_average) + " ms, budget " +
+                 std::to_string(m_settings.budgetMs) + " ms)");
+    }
+    m_raised = level < m_level;
+    m_level = level;
+    m_hasAverage = false;
+    m_overFrames = 0;
+    m_underFrames = 0;
+    m_framesAtLevel = 0;
+}
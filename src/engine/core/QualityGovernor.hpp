@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Holds engine work per frame under a time budget by trading quality.
+//
+// Callers report what each stage cost (addCost) and close the frame with
+// endFrame(). The governor keeps a smoothed total and walks a ladder of
+// quality levels: a level down once the cost has overrun the budget for
+// degradeFrames frames in a row, a level up once it has stayed under
+// recoverRatio of the budget for recoverFrames frames. Recovering is
+// deliberately slower than degrading, and a level that overran soon after
+// being restored waits twice as long before the next attempt, so the
+// governor settles instead of oscillating between two levels.
+//
+// Level 0 is full quality. The governor only decides; the systems read
+// getLevel() and apply it.
+class QualityGovernor {
+public:
+    // One rung of the ladder. Later rungs should be cheaper.
+    struct Level {
+        uint32_t overlayStride = 1;  // Overlay colour computed once per stride x stride block
+        uint32_t statsInterval = 1;  // Refresh export stats every n-th frame
+        uint32_t substeps = 1;       // Ticks folded into one diffusion pass (TemperatureSystem::updateCoarse)
+        uint32_t agentLod = 0;       // Agent detail to drop, 0 = none (read by the agent update)
+    };
+
+    enum class Stage {
+        Tick,
+        Export,
+        Count
+    };
+
+    struct Settings {
+        double budgetMs = 8.0;        // Engine share of a 60 Hz frame; the rest is rendering
+        double smoothing = 0.1;       // Weight of the newest frame in the average
+        double recoverRatio = 0.6;    // Headroom needed before raising quality
+        uint32_t degradeFrames = 10;
+        uint32_t recoverFrames = 120;
+        uint32_t maxRecoverFrames = 1920;
+    };
+
+    // Overlay, then stats, then substeps, then agents
+    static std::vector<Level> defaultLadder();
+
+    QualityGovernor();
+    QualityGovernor(std::vector<Level> ladder, const Settings& settings);
+
+    void addCost(Stage stage, double milliseconds);
+
+    // Fold this frame's costs into the average and move along the ladder.
+    // Returns true if the level changed.
+    bool endFrame();
+
+    const Level& getLevel() const { return m_ladder[m_level]; }
+    size_t getLevelIndex() const { return m_level; }
+    size_t getLevelCount() const { return m_ladder.size(); }
+
+    // Smoothed cost per frame and the last frame's cost of one stage
+    double getAverageCost() const { return m_average; }
+    double getStageCost(Stage stage) const { return m_lastCosts[static_cast<size_t>(stage)]; }
+
+    const Settings& getSettings() const { return m_settings; }
+    void setBudget(double milliseconds);
+
+    // Replace the ladder; the level is clamped to it. An empty ladder is
+    // treated as a single full-quality level.
+    void setLadder(std::vector<Level> ladder);
+
+    // Jump to a level, e.g. from a settings menu. Disable the governor to
+    // keep it there.
+    void setLevel(size_t level);
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+
+private:
+    void moveTo(size_t level);
+
+    std::vector<Level> m_ladder;
+    Settings m_settings;
+    size_t m_level = 0;
+    bool m_enabled = true;
+
+    double m_costs[static_cast<size_t>(Stage::Count)] = {};
+    double m_lastCosts[static_cast<size_t>(Stage::Count)] = {};
+    double m_average = 0.0;
+    bool m_hasAverage = false;
+
+    uint32_t m_overFrames = 0;
+    uint32_t m_underFrames = 0;
+    uint32_t m_framesAtLevel = 0;
+    bool m_raised = false;                  // Current level was reached by raising quality
+    std::vector<uint32_t> m_recoverFrames;  // Per level: wait before raising quality to it
+};
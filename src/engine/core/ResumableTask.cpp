@@ -0,0 +1,30 @@
+#include "ResumableTask.hpp"
+#include "../Logging.hpp"
+#include <chrono>
+#include <exception>
+
+ResumableTask::Status ResumableTask::step(uint32_t budgetMicros) {
+    if (m_status != Status::Running) return m_status;
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(budgetMicros);
+    try {
+        do {
+            if (advance()) {
+                m_status = Status::Done;
+                m_progress = 1.0;
+                break;
+            }
+        } while (Clock::now() < deadline);
+    } catch (const std::exception& e) {
+        m_status = Status::Failed;
+        m_error = e.what();
+        LOG_ERROR("Task failed during '" + m_phase + "': " + m_error);
+    }
+    return m_status;
+}
+
+ResumableTask::Status ResumableTask::runToCompletion() {
+    while (step(UINT32_MAX) == Status::Running) {}
+    return m_status;
+}
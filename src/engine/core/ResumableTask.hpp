@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Long engine operation split into small resumable slices.
+//
+// A task is a state machine: advance() does one bounded unit of work (a few
+// rows, one tick) and keeps its position in members, so step() can stop
+// between any two units. The JS frame loop calls step() with what is left of
+// the frame budget and reports getProgress(), so saves, loads and
+// fast-forwards run across frames instead of freezing the tab.
+//
+// Exceptions thrown by advance() end the task as Failed with the message in
+// getError(); nothing escapes step().
+class ResumableTask {
+public:
+    enum class Status {
+        Running,
+        Done,
+        Failed
+    };
+
+    virtual ~ResumableTask() = default;
+
+    // Run units until `budgetMicros` has elapsed or the task ends. Always
+    // runs at least one unit, so a zero budget still makes progress.
+    Status step(uint32_t budgetMicros);
+
+    // Run to completion (native tools, tests)
+    Status runToCompletion();
+
+    Status getStatus() const { return m_status; }
+    bool isFinished() const { return m_status != Status::Running; }
+
+    // Fraction done (0-1) and a short description of the current phase
+    double getProgress() const { return m_progress; }
+    const std::string& getPhase() const { return m_phase; }
+    const std::string& getError() const { return m_error; }
+
+protected:
+    // Do one unit of work. Return true when the task is complete.
+    virtual bool advance() = 0;
+
+    void setProgress(double progress) { m_progress = progress; }
+    void setPhase(const std::string& phase) { m_phase = phase; }
+
+private:
+    Status m_status = Status::Running;
+    double m_progress = 0.0;
+    std::string m_phase;
+    std::string m_error;
+};
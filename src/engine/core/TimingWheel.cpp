@@ -0,0 +1,211 @@
+#include "TimingWheel.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// First set bit at or after `from` in a 256-bit map, or 256 if none
+uint32_t nextSetBit(const uint64_t* words, uint32_t from) {
+    for (uint32_t w = from / 64; w < 4; ++w) {
+        uint64_t bits = words[w];
+        if (w == from / 64) {
+            bits &= ~uint64_t{0} << (from % 64);
+        }
+        if (bits) {
+            uint32_t bit = 0;
+            while (!(bits & 1)) {
+                bits >>= 1;
+                ++bit;
+            }
+            return w * 64 + bit;
+        }
+    }
+    return 256;
+}
+
+} // namespace
+
+TimingWheel::TimingWheel(uint64_t now)
+    : m_now(now) {
+    std::fill(std::begin(m_heads), std::end(m_heads), NO_NODE);
+}
+
+TimingWheel::TimerId TimingWheel::schedule(uint64_t due, uint32_t kind, uint64_t data) {
+    const uint32_t index = allocateNode();
+    Node& node = m_nodes[index];
+    node.due = std::max(due, m_now + 1);
+    node.sequence = m_sequence++;
+    node.data = data;
+    node.kind = kind;
+    place(index);
+    ++m_pending;
+    return makeId(index, node.generation);
+}
+
+bool TimingWheel::isPending(TimerId id) const {
+    const uint64_t index = (id & 0xFFFFFFFFu) - 1;
+    if (id == NO_TIMER || index >= m_nodes.size()) return false;
+    const Node& node = m_nodes[index];
+    return node.generation == static_cast<uint32_t>(id >> 32) && node.list != NO_NODE;
+}
+
+bool TimingWheel::cancel(TimerId id) {
+    if (!isPending(id)) return false;
+    const uint32_t index = static_cast<uint32_t>((id & 0xFFFFFFFFu) - 1);
+    unlink(index);
+    freeNode(index);
+    --m_pending;
+    return true;
+}
+
+size_t TimingWheel::advance(uint64_t now, std::vector<Fired>& out) {
+    size_t fired = 0;
+    for (;;) {
+        const uint64_t tick = nextEventTick();
+        if (tick > now) break;
+        m_now = tick;
+
+        // Coarsest first, so timers cascading down several levels at once
+        // land in the finer slots before those are emptied in turn
+        if ((tick & 0xFFFFFFFFu) == 0) {
+            cascade(OVERFLOW_LIST);
+        }
+        for (uint32_t level = LEVELS - 1; level > 0; --level) {
+            const uint32_t shift = level * SLOT_BITS;
+            if ((tick & ((uint64_t{1} << shift) - 1)) == 0) {
+                cascade(level * SLOTS + static_cast<uint32_t>((tick >> shift) & (SLOTS - 1)));
+            }
+        }
+
+        // Everything left in the level 0 slot is due exactly now
+        m_firing.clear();
+        for (uint32_t n = detach(static_cast<uint32_t>(tick & (SLOTS - 1))); n != NO_NODE; n = m_nodes[n].next) {
+            m_firing.push_back(n);
+        }
+        std::sort(m_firing.begin(), m_firing.end(), [this](uint32_t a, uint32_t b) {
+            return m_nodes[a].sequence < m_nodes[b].sequence;
+        });
+        for (uint32_t n : m_firing) {
+            const Node& node = m_nodes[n];
+            out.push_back({makeId(n, node.generation), node.due, node.data, node.kind});
+            freeNode(n);
+        }
+        m_pending -= m_firing.size();
+        fired += m_firing.size();
+    }
+    m_now = std::max(m_now, now);
+    return fired;
+}
+
+void TimingWheel::clear() {
+    for (uint32_t index = 0; index < m_nodes.size(); ++index) {
+        if (m_nodes[index].list != NO_NODE) {
+            freeNode(index);
+        }
+    }
+    std::fill(std::begin(m_heads), std::end(m_heads), NO_NODE);
+    for (auto& level : m_occupied) {
+        std::fill(std::begin(level), std::end(level), 0);
+    }
+    m_pending = 0;
+}
+
+uint64_t TimingWheel::nextEventTick() const {
+    // A timer on level l shares every bit above its slot with m_now and sits
+    // in a later slot, so each level's next occupied slot gives the tick its
+    // timers next need attention: the start of that slot's span
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (uint32_t level = 0; level < LEVELS; ++level) {
+        const uint32_t shift = level * SLOT_BITS;
+        const uint32_t current = static_cast<uint32_t>((m_now >> shift) & (SLOTS - 1));
+        const uint32_t slot = nextSetBit(m_occupied[level], current + 1);
+        if (slot < SLOTS) {
+            const uint64_t block = m_now & ~((uint64_t{1} << (shift + SLOT_BITS)) - 1);
+            best = std::min(best, block | static_cast<uint64_t>(slot) << shift);
+        }
+    }
+    if (m_heads[OVERFLOW_LIST] != NO_NODE) {
+        best = std::min(best, ((m_now >> 32) + 1) << 32);
+    }
+    return best;
+}
+
+void TimingWheel::place(uint32_t index) {
+    const uint64_t due = m_nodes[index].due;
+    const uint64_t distance = due ^ m_now;
+    for (uint32_t level = 0; level < LEVELS; ++level) {
+        const uint32_t shift = level * SLOT_BITS;
+        if (distance < (uint64_t{1} << (shift + SLOT_BITS))) {
+            link(index, level * SLOTS + static_cast<uint32_t>((due >> shift) & (SLOTS - 1)));
+            return;
+        }
+    }
+    link(index, OVERFLOW_LIST);
+}
+
+void TimingWheel::link(uint32_t index, uint32_t list) {
+    Node& node = m_nodes[index];
+    node.list = list;
+    node.prev = NO_NODE;
+    node.next = m_heads[list];
+    if (node.next != NO_NODE) {
+        m_nodes[node.next].prev = index;
+    }
+    m_heads[list] = index;
+    if (list < OVERFLOW_LIST) {
+        m_occupied[list / SLOTS][(list % SLOTS) / 64] |= uint64_t{1} << (list % 64);
+    }
+}
+
+void TimingWheel::unlink(uint32_t index) {
+    Node& node = m_nodes[index];
+    const uint32_t list = node.list;
+    if (node.prev != NO_NODE) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_heads[list] = node.next;
+    }
+    if (node.next != NO_NODE) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    if (m_heads[list] == NO_NODE && list < OVERFLOW_LIST) {
+        m_occupied[list / SLOTS][(list % SLOTS) / 64] &= ~(uint64_t{1} << (list % 64));
+    }
+}
+
+uint32_t TimingWheel::detach(uint32_t list) {
+    const uint32_t head = m_heads[list];
+    m_heads[list] = NO_NODE;
+    if (list < OVERFLOW_LIST) {
+        m_occupied[list / SLOTS][(list % SLOTS) / 64] &= ~(uint64_t{1} << (list % 64));
+    }
+    return head;
+}
+
+void TimingWheel::cascade(uint32_t list) {
+    uint32_t n = detach(list);
+    while (n != NO_NODE) {
+        const uint32_t next = m_nodes[n].next;
+        place(n);
+        n = next;
+    }
+}
+
+uint32_t TimingWheel::allocateNode() {
+    if (m_freeHead != NO_NODE) {
+        const uint32_t index = m_freeHead;
+        m_freeHead = m_nodes[index].next;
+        return index;
+    }
+    m_nodes.emplace_back();
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+void TimingWheel::freeNode(uint32_t index) {
+    Node& node = m_nodes[index];
+    node.generation = node.generation + 1 ? node.generation + 1 : 1;
+    node.list = NO_NODE;
+    node.prev = NO_NODE;
+    node.next = m_freeHead;
+    m_freeHead = index;
+}
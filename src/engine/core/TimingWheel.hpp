@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel for sparse timed events (gestation, cooldowns,
+// delayed reactions, emitters switching on and off).
+//
+// Four levels of 256 slots cover 2^8, 2^16, 2^24 and 2^32 ticks ahead; later
+// timers wait in an overflow list. A timer lives in the coarsest slot that
+// still separates it from the current tick and drops to finer levels as
+// time reaches its slot ("cascading"), so schedule and cancel are O(1) and
+// each timer is touched at most once per level.
+//
+// advance() jumps straight to the next tick with work, found from per-level
+// occupancy bitmaps, so its cost follows the timers that fire (plus one
+// step per occupied coarse slot), not the ticks elapsed or timers pending.
+// Timers due on the same tick fire in the order they were scheduled.
+// Not thread-safe.
+class TimingWheel {
+public:
+    // 0 is never a valid id; ids of fired or cancelled timers go stale
+    using TimerId = uint64_t;
+    static constexpr TimerId NO_TIMER = 0;
+
+    struct Fired {
+        TimerId id;
+        uint64_t due;
+        uint64_t data;   // Caller's payload, e.g. an entity handle
+        uint32_t kind;   // Caller's event type
+    };
+
+    explicit TimingWheel(uint64_t now = 0);
+
+    // Fire at tick `due`. A tick already reached is moved to getNow() + 1:
+    // the timer fires on the first advance() past the current tick, and
+    // Fired::due reports that moved tick, not the one asked for.
+    TimerId schedule(uint64_t due, uint32_t kind, uint64_t data = 0);
+    TimerId scheduleAfter(uint64_t delay, uint32_t kind, uint64_t data = 0) {
+        return schedule(m_now + delay, kind, data);
+    }
+
+    // False if the timer already fired or was cancelled
+    bool cancel(TimerId id);
+    bool isPending(TimerId id) const;
+
+    // Move time forward to `now`, appending the timers that fall due to
+    // `out` in (due, schedule order) order. Returns how many fired.
+    size_t advance(uint64_t now, std::vector<Fired>& out);
+
+    uint64_t getNow() const { return m_now; }
+    size_t getPendingCount() const { return m_pending; }
+
+    // Drop every timer; time stays where it is
+    void clear();
+
+private:
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint32_t SLOT_BITS = 8;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint32_t OVERFLOW_LIST = LEVELS * SLOTS;   // List index of the overflow list
+    static constexpr uint32_t NO_NODE = 0xFFFFFFFFu;
+
+    struct Node {
+        uint64_t due = 0;
+        uint64_t sequence = 0;
+        uint64_t data = 0;
+        uint32_t kind = 0;
+        uint32_t generation = 1;
+        uint32_t prev = NO_NODE;
+        uint32_t next = NO_NODE;
+        uint32_t list = NO_NODE;   // Slot list it is on; NO_NODE when free
+    };
+
+    static TimerId makeId(uint32_t index, uint32_t generation) {
+        return static_cast<uint64_t>(generation) << 32 | (index + 1);
+    }
+
+    uint32_t allocateNode();
+    void freeNode(uint32_t index);
+
+    // Put a node with due >= m_now on the list its distance calls for
+    void place(uint32_t index);
+    void link(uint32_t index, uint32_t list);
+    void unlink(uint32_t index);
+
+    // Take a whole list, leaving it empty; returns its first node
+    uint32_t detach(uint32_t list);
+    void cascade(uint32_t list);
+
+    uint64_t nextEventTick() const;
+
+    uint64_t m_now;
+    uint64_t m_sequence = 0;
+    size_t m_pending = 0;
+
+    std::vector<Node> m_nodes;
+    uint32_t m_freeHead = NO_NODE;
+
+    uint32_t m_heads[LEVELS * SLOTS + 1];
+    uint64_t m_occupied[LEVELS][SLOTS / 64] = {};  // Non-empty slots per level
+
+    std::vector<uint32_t> m_firing;  // Scratch for advance()
+};
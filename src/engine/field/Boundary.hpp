@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Boundary handling for padded grid planes.
+//
+// Fields are stored with a one-cell ghost ring around the (width x height)
+// interior. The ring is refreshed once per tick from the boundary condition,
+// after which every interior cell runs the same branch-free stencil kernel no
+// matter what lies beyond the edge.
+
+enum class BoundaryKind : uint8_t {
+    Dirichlet,  // Ghost cells hold a fixed temperature
+    Neumann,    // Ghost cells mirror the edge cell: insulated, zero flux
+    Periodic    // Ghost cells wrap to the opposite edge (toroidal world)
+};
+
+struct BoundaryCondition {
+    BoundaryKind kind = BoundaryKind::Neumann;
+    double value = 0.0;  // Ghost value for Dirichlet boundaries
+};
+
+// Fill the ghost ring of a padded plane. `plane` points at ghost cell (-1, -1);
+// interior cell (x, y) lives at plane[(y + 1) * stride + (x + 1)] with
+// stride >= width + 2.
+template <typename T>
+inline void refreshGhostRing(T* plane, uint32_t width, uint32_t height,
+                             size_t stride, const BoundaryCondition& bc) {
+    if (width == 0 || height == 0) return;
+
+    T* top = plane;
+    T* firstRow = plane + stride;
+    T* lastRow = plane + static_cast<size_t>(height) * stride;
+    T* bottom = plane + static_cast<size_t>(height + 1) * stride;
+    const T fixed = static_cast<T>(bc.value);
+
+    switch (bc.kind) {
+        case BoundaryKind::Dirichlet:
+            for (uint32_t x = 0; x < width + 2; ++x) {
+                top[x] = fixed;
+                bottom[x] = fixed;
+            }
+            for (uint32_t y = 1; y <= height; ++y) {
+                T* row = plane + static_cast<size_t>(y) * stride;
+                row[0] = fixed;
+                row[width + 1] = fixed;
+            }
+            break;
+
+        case BoundaryKind::Neumann:
+            for (uint32_t y = 1; y <= height; ++y) {
+                T* row = plane + static_cast<size_t>(y) * stride;
+                row[0] = row[1];
+                row[width + 1] = row[width];
+            }
+            // Whole rows, so the corners pick up the side ghosts just written
+            for (uint32_t x = 0; x < width + 2; ++x) {
+                top[x] = firstRow[x];
+                bottom[x] = lastRow[x];
+            }
+            break;
+
+        case BoundaryKind::Periodic:
+            for (uint32_t y = 1; y <= height; ++y) {
+                T* row = plane + static_cast<size_t>(y) * stride;
+                row[0] = row[width];
+                row[width + 1] = row[1];
+            }
+            for (uint32_t x = 0; x < width + 2; ++x) {
+                top[x] = lastRow[x];
+                bottom[x] = firstRow[x];
+            }
+            break;
+    }
+}
+
+// Map a coordinate up to one cell outside the interior onto the interior cell
+// its ghost mirrors. Returns false for Dirichlet, whose ghosts hold bc.value.
+// Used by layouts without a stored ghost ring (see field/GridLayout.hpp).
+inline bool resolveGhost(int& x, int& y, uint32_t width, uint32_t height,
+                         const BoundaryCondition& bc) {
+    const int w = static_cast<int>(width);
+    const int h = static_cast<int>(height);
+    if (x >= 0 && y >= 0 && x < w && y < h) return true;
+
+    switch (bc.kind) {
+        case BoundaryKind::Dirichlet:
+            return false;
+        case BoundaryKind::Neumann:
+            x = x < 0 ? 0 : (x >= w ? w - 1 : x);
+            y = y < 0 ? 0 : (y >= h ? h - 1 : y);
+            return true;
+        case BoundaryKind::Periodic:
+            x = x < 0 ? x + w : (x >= w ? x - w : x);
+            y = y < 0 ? y + h : (y >= h ? y - h : y);
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,169 @@
+#include "FFT.hpp"
+#include <cmath>
+#include <utility>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+bool isPowerOfTwo(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+} // namespace
+
+FFTPlan::FFTPlan(size_t n)
+    : m_size(n), m_pow2(isPowerOfTwo(n)) {
+    if (n <= 1) {
+        m_pow2 = true;
+        return;
+    }
+
+    if (m_pow2) {
+        size_t bits = 0;
+        while ((size_t{1} << bits) < n) ++bits;
+        m_bitReverse.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            size_t r = 0;
+            for (size_t b = 0; b < bits; ++b) {
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            m_bitReverse[i] = r;
+        }
+
+        // Stage with half-length h uses twiddles [h - 1, 2h - 1)
+        m_twiddleRe.resize(n - 1);
+        m_twiddleIm.resize(n - 1);
+        for (size_t half = 1; half < n; half <<= 1) {
+            for (size_t j = 0; j < half; ++j) {
+                const double angle = -PI * static_cast<double>(j) / static_cast<double>(half);
+                m_twiddleRe[half - 1 + j] = std::cos(angle);
+                m_twiddleIm[half - 1 + j] = std::sin(angle);
+            }
+        }
+        return;
+    }
+
+    // Bluestein: X(k) = w(k) * sum [x(n) w(n)] conj(w(k - n)), w(k) = e^(-i pi k^2 / N)
+    size_t padded = 1;
+    while (padded < 2 * n - 1) padded <<= 1;
+    m_inner.emplace_back(padded);
+
+    m_chirpRe.resize(n);
+    m_chirpIm.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        // k^2 mod 2N keeps the angle small for large k
+        const size_t k2 = (k * k) % (2 * n);
+        const double angle = -PI * static_cast<double>(k2) / static_cast<double>(n);
+        m_chirpRe[k] = std::cos(angle);
+        m_chirpIm[k] = std::sin(angle);
+    }
+
+    m_filterRe.assign(padded, 0.0);
+    m_filterIm.assign(padded, 0.0);
+    m_filterRe[0] = m_chirpRe[0];
+    m_filterIm[0] = -m_chirpIm[0];
+    for (size_t k = 1; k < n; ++k) {
+        m_filterRe[k] = m_filterRe[padded - k] = m_chirpRe[k];
+        m_filterIm[k] = m_filterIm[padded - k] = -m_chirpIm[k];
+    }
+    m_inner[0].radix2(m_filterRe.data(), m_filterIm.data());
+}
+
+void FFTPlan::forward(double* re, double* im, Workspace& ws) const {
+    if (m_size <= 1) return;
+    if (m_pow2) {
+        radix2(re, im);
+    } else {
+        bluestein(re, im, ws);
+    }
+}
+
+void FFTPlan::radix2(double* __restrict re, double* __restrict im) const {
+    const size_t n = m_size;
+    for (size_t i = 0; i < n; ++i) {
+        const size_t j = m_bitReverse[i];
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    for (size_t half = 1; half < n; half <<= 1) {
+        const double* __restrict wr = m_twiddleRe.data() + half - 1;
+        const double* __restrict wi = m_twiddleIm.data() + half - 1;
+        for (size_t block = 0; block < n; block += 2 * half) {
+            double* __restrict ar = re + block;
+            double* __restrict ai = im + block;
+            double* __restrict br = re + block + half;
+            double* __restrict bi = im + block + half;
+            for (size_t j = 0; j < half; ++j) {
+                const double tr = br[j] * wr[j] - bi[j] * wi[j];
+                const double ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+void FFTPlan::bluestein(double* re, double* im, Workspace& ws) const {
+    const size_t n = m_size;
+    const FFTPlan& inner = m_inner[0];
+    const size_t padded = inner.size();
+
+    ws.padRe.assign(padded, 0.0);
+    ws.padIm.assign(padded, 0.0);
+    for (size_t k = 0; k < n; ++k) {
+        ws.padRe[k] = re[k] * m_chirpRe[k] - im[k] * m_chirpIm[k];
+        ws.padIm[k] = re[k] * m_chirpIm[k] + im[k] * m_chirpRe[k];
+    }
+
+    inner.radix2(ws.padRe.data(), ws.padIm.data());
+
+    // Pointwise multiply by the filter, conjugating so the inverse transform
+    // can reuse the forward kernel: ifft(X) = conj(fft(conj(X))) / N
+    for (size_t k = 0; k < padded; ++k) {
+        const double r = ws.padRe[k] * m_filterRe[k] - ws.padIm[k] * m_filterIm[k];
+        const double i = ws.padRe[k] * m_filterIm[k] + ws.padIm[k] * m_filterRe[k];
+        ws.padRe[k] = r;
+        ws.padIm[k] = -i;
+    }
+
+    inner.radix2(ws.padRe.data(), ws.padIm.data());
+
+    const double scale = 1.0 / static_cast<double>(padded);
+    for (size_t k = 0; k < n; ++k) {
+        const double cr = ws.padRe[k] * scale;
+        const double ci = -ws.padIm[k] * scale;
+        re[k] = cr * m_chirpRe[k] - ci * m_chirpIm[k];
+        im[k] = cr * m_chirpIm[k] + ci * m_chirpRe[k];
+    }
+}
+
+void FFTPlan::hartleyPair(double* a, double* b, Workspace& ws) const {
+    const size_t n = m_size;
+    if (n <= 1) return;
+
+    // Pack z = a + i b, transform once, then split the two spectra using
+    // conjugate symmetry. H(k) = Re X(k) - Im X(k) for a real input.
+    ws.re.assign(a, a + n);
+    if (b) {
+        ws.im.assign(b, b + n);
+    } else {
+        ws.im.assign(n, 0.0);
+    }
+    forward(ws.re.data(), ws.im.data(), ws);
+
+    for (size_t k = 0; k < n; ++k) {
+        const size_t m = (n - k) % n;
+        const double zr = ws.re[k], zi = ws.im[k];
+        const double mr = ws.re[m], mi = ws.im[m];
+        a[k] = 0.5 * ((zr + mr) - (zi - mi));
+        if (b) {
+            b[k] = 0.5 * ((zi + mi) + (zr - mr));
+        }
+    }
+}
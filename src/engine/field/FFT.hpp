@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// In-place complex FFT on split real/imaginary arrays.
+//
+// Power-of-two sizes use an iterative radix-2 transform whose butterflies
+// walk contiguous re/im arrays with a per-stage twiddle table, so each stage
+// is a unit-stride loop the compiler vectorizes (SSE/AVX natively, simd128 on
+// WASM). Other sizes go through Bluestein's algorithm on a padded power-of-two
+// plan.
+//
+// A plan is immutable after construction and may be shared between threads;
+// each thread passes its own Workspace.
+class FFTPlan {
+public:
+    struct Workspace {
+        std::vector<double> re;     // Packed input for hartleyPair()
+        std::vector<double> im;
+        std::vector<double> padRe;  // Bluestein convolution buffers
+        std::vector<double> padIm;
+    };
+
+    explicit FFTPlan(size_t n);
+
+    size_t size() const { return m_size; }
+
+    // Forward transform, X(k) = sum x(n) e^(-2 pi i k n / N). Unnormalized.
+    void forward(double* re, double* im, Workspace& ws) const;
+
+    // Real-to-real discrete Hartley transform of two real sequences at once,
+    // H(k) = sum x(n) (cos + sin)(2 pi k n / N). `b` may be null. The DHT is
+    // its own inverse up to a factor of N.
+    void hartleyPair(double* a, double* b, Workspace& ws) const;
+
+private:
+    void radix2(double* re, double* im) const;
+    void bluestein(double* re, double* im, Workspace& ws) const;
+
+    size_t m_size;
+    bool m_pow2;
+
+    // Radix-2 tables
+    std::vector<size_t> m_bitReverse;
+    std::vector<double> m_twiddleRe;  // Stage twiddles, concatenated
+    std::vector<double> m_twiddleIm;
+
+    // Bluestein tables
+    std::vector<FFTPlan> m_inner;     // Padded power-of-two plan (0 or 1 entries)
+    std::vector<double> m_chirpRe;    // e^(-i pi k^2 / N)
+    std::vector<double> m_chirpIm;
+    std::vector<double> m_filterRe;   // FFT of the conjugate chirp, padded
+    std::vector<double> m_filterIm;
+};
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Boundary.hpp"
+#include "GridLayout.hpp"
+#include "Stencil.hpp"
+#include "../core/JobSystem.hpp"
+#include "../memory/GridAllocator.hpp"
+
+// N scalar fields of type T that share one grid layout and one update pass.
+//
+// Resources, pheromones, pressure and the like all follow the same pattern:
+// diffuse with a stencil, decay by a fixed fraction, add a per-cell source.
+// FieldSystem stores each field as its own plane (same layout, chunking and
+// NUMA placement as TemperatureSystem) and update() advances all of them in
+// a single fused sweep: for each row (or tile) it runs every field's kernel
+// before moving on, so the grid is traversed once per tick instead of once
+// per field, and each band's rows stay in its worker's cache across fields.
+//
+// Decay is folded into the stencil coefficients, so a field costs one stencil
+// evaluation per cell plus a source add when it has sources.
+//
+// Dirty tracking works on 32x32 chunks (the tile size): a chunk is marked
+// when a cell in it is written through set()/addSource() or changes by more
+// than the change threshold during update(). Exporters copy dirty chunks and
+// call clearDirty().
+//
+// Typical use:
+//     enum Field { Food, Scent, FieldCount };
+//     FieldSystem<float, FieldCount> fields(w, h);
+//     fields.setParams(Scent, {0.2, 0.01});
+template <typename T, size_t N, typename S = FivePointStencil>
+class FieldSystem {
+public:
+    static constexpr size_t FIELD_COUNT = N;
+    static constexpr uint32_t CHUNK_SHIFT = GridLayout::TILE_SHIFT;
+    static constexpr uint32_t CHUNK_SIZE = GridLayout::TILE_SIZE;
+
+    struct FieldParams {
+        double diffusionRate = 0.0;   // Stencil rate (0-1), same meaning as TemperatureSystem
+        double decayRate = 0.0;       // Fraction lost per tick (0-1)
+        BoundaryCondition boundary;   // What lies beyond the map edge
+    };
+
+    FieldSystem(uint32_t width, uint32_t height,
+                GridLayout::Kind layout = GridLayout::Kind::RowMajor, T initial = T(0));
+
+    uint32_t getWidth() const { return m_width; }
+    uint32_t getHeight() const { return m_height; }
+    const GridLayout& getLayout() const { return m_layout; }
+
+    void setParams(size_t field, const FieldParams& params) { m_params[field] = params; }
+    const FieldParams& getParams(size_t field) const { return m_params[field]; }
+
+    T get(size_t field, uint32_t x, uint32_t y) const;
+    void set(size_t field, uint32_t x, uint32_t y, T value);
+    void fill(size_t field, T value);
+
+    // Persistent per-cell emission, added to the field every update(). The
+    // field's source plane is allocated on first use.
+    void addSource(size_t field, uint32_t x, uint32_t y, T ratePerTick);
+    void clearSources(size_t field);
+
+    // Advance every field one tick in a single fused sweep
+    void update();
+
+    // Copy a field to a dense row-major width x height array
+    void copyField(size_t field, T* out) const { m_layout.gather(m_current[field].data(), out); }
+    void loadField(size_t field, const T* in);
+
+    // Chunk grid and dirty tracking
+    uint32_t chunksX() const { return m_chunksX; }
+    uint32_t chunksY() const { return m_chunksY; }
+    bool isChunkDirty(uint32_t cx, uint32_t cy) const {
+        return m_dirty[static_cast<size_t>(cy) * m_chunksX + cx].load(std::memory_order_relaxed) != 0;
+    }
+    size_t countDirtyChunks() const;
+    void clearDirty();
+
+    // Copy one chunk of a field row-major into `out` (up to CHUNK_SIZE^2
+    // values; edge chunks are smaller). Returns the number of cells written.
+    size_t copyChunk(size_t field, uint32_t cx, uint32_t cy, T* out) const;
+
+    // Smallest per-cell change update() reports as dirty (default: any change)
+    void setChangeThreshold(T threshold) { m_changeThreshold = threshold; }
+
+private:
+    using Plane = std::vector<T, GridAllocator<T>>;
+
+    // Rows per band for row-major passes; matches TemperatureSystem so both
+    // systems split the grid across workers the same way
+    static constexpr size_t ROW_BAND_GRAIN = 16;
+
+    size_t bandUnits() const { return m_layout.isTiled() ? m_layout.tileCount() : m_height; }
+    size_t bandGrain() const { return m_layout.isTiled() ? 1 : ROW_BAND_GRAIN; }
+
+    // A field with no diffusion, decay or sources never changes
+    bool isStatic(size_t field) const {
+        return m_params[field].diffusionRate == 0.0 && m_params[field].decayRate == 0.0 &&
+               m_source[field].empty();
+    }
+
+    void markChunk(uint32_t x, uint32_t y) {
+        m_dirty[static_cast<size_t>(y >> CHUNK_SHIFT) * m_chunksX + (x >> CHUNK_SHIFT)]
+            .store(1, std::memory_order_relaxed);
+    }
+
+    // Mark the chunks of cells [0, count) starting at column x0 of row y
+    // whose values moved by more than the change threshold
+    void markChangedSpan(const T* before, const T* after, uint32_t count, uint32_t x0, uint32_t y);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    GridLayout m_layout;
+    std::array<Plane, N> m_current;
+    std::array<Plane, N> m_next;
+    std::array<Plane, N> m_source;       // Empty until the field's first addSource()
+    std::array<FieldParams, N> m_params;
+    T m_changeThreshold = T(0);
+
+    uint32_t m_chunksX;
+    uint32_t m_chunksY;
+    std::unique_ptr<std::atomic<uint8_t>[]> m_dirty;  // Written concurrently by bands
+};
+
+template <typename T, size_t N, typename S>
+FieldSystem<T, N, S>::FieldSystem(uint32_t width, uint32_t height, GridLayout::Kind layout, T initial)
+    : m_width(width), m_height(height), m_layout(layout, width, height),
+      m_chunksX((width + GridLayout::TILE_MASK) >> CHUNK_SHIFT),
+      m_chunksY((height + GridLayout::TILE_MASK) >> CHUNK_SHIFT),
+      m_dirty(new std::atomic<uint8_t>[static_cast<size_t>(m_chunksX) * m_chunksY]) {
+    clearDirty();
+
+    // Planes are allocated untouched and first written band by band, so each
+    // worker's rows land on its own NUMA node (see memory/GridAllocator.hpp)
+    for (size_t f = 0; f < N; ++f) {
+        m_current[f].resize(m_layout.storageSize());
+        m_next[f].resize(m_layout.storageSize());
+    }
+    const size_t units = bandUnits();
+    JobSystem::get().parallelFor(units, [&](size_t begin, size_t end, unsigned) {
+        size_t first, last;
+        if (m_layout.isTiled()) {
+            first = begin * GridLayout::TILE_CELLS;
+            last = end * GridLayout::TILE_CELLS;
+        } else {
+            const size_t stride = m_layout.rowStride();
+            first = begin == 0 ? 0 : (begin + 1) * stride;
+            last = end == units ? m_layout.storageSize() : (end + 1) * stride;
+        }
+        for (size_t f = 0; f < N; ++f) {
+            std::fill(m_current[f].begin() + first, m_current[f].begin() + last, initial);
+            std::fill(m_next[f].begin() + first, m_next[f].begin() + last, initial);
+        }
+    }, bandGrain());
+}
+
+template <typename T, size_t N, typename S>
+T FieldSystem<T, N, S>::get(size_t field, uint32_t x, uint32_t y) const {
+    if (x >= m_width || y >= m_height) return T(0);
+    return m_current[field][m_layout.index(x, y)];
+}
+
+template <typename T, size_t N, typename S>
+void FieldSystem<T, N, S>::set(size_t field, uint32_t x, uint32_t y, T value) {
+    if (x >= m_width || y >= m_height) return;
+    m_current[field][m_layout.index(x, y)] = value;
+    markChunk(x, y);
+}
+
+template <typename T, size_t N, typename S>
+void FieldSystem<T, N, S>::fill(size_t field, T value) {
+    std::fill(m_current[field].begin(), m_current[field].end(), value);
+    for (size_t i = 0; i < static_cast<size_t>(m_chunksX) * m_chunksY; ++i) {
+        m_dirty[i].store(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, size_t N, typename S>
+void FieldSystem<T, N, S>::addSource(size_t field, uint32_t x, uint32_t y, T ratePerTick) {
+    if (x >= m_width || y >= m_height) return;
+    Plane& source = m_source[field];
+    if (source.empty()) {
+        source.assign(m_layout.storageSize(), T(0));
+    }
+    source[m_layout.index(x, y)] += ratePerTick;
+    markChunk(x, y);
+}
+
+template <typename T, size_t N, typename S>
+void FieldSystem<T, N, S>::clearSources(size_t field) {
+    Plane().swap(m_source[field]);
+}
+
+template <typename T, size_t N, typename S>
+void FieldSystem<T, N, S>::loadField(size_t field, const T* in) {
+    m_layout.scatter(in, m_current[field].data());
+    for (size_t i = 0; i < static_cast<size_t>(m_chunksX) * m_chunksY; ++i) {
+        m_dirty[i].store(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, size_t N, typename S>
+size_t FieldSystem<T, N, S>::countDirtyChunks() const {
+    size_t count = 0;
+    for (size_t i = 0; i < static_cast<size_t>(m_chunksX) * m_chunksY; ++i) {
+        count += m_dirty[i].load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+template <typename T, size_t N, typename S>
+void FieldSystem<T, N, S>::clearDirty() {
+    for (size_t i = 0; i < static_cast<size_t>(m_chunksX) * m_chunksY; ++i) {
+        m_dirty[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, size_t N, typename S>
+size_t FieldSystem<T, N, S>::copyChunk(size_t field, uint32_t cx, uint32_t cy, T* out) const {
+    const uint32_t x0 = cx << CHUNK_SHIFT;
+    const uint32_t y0 = cy << CHUNK_SHIFT;
+    if (x0 >= m_width || y0 >= m_height) return 0;
+    const uint32_t w = std::min(CHUNK_SIZE, m_width - x0);
+    const uint32_t h = std::min(CHUNK_SIZE, m_height - y0);
+
+    // Rows of a chunk are contiguous in every layout (a row-major row, or a tile row)
+    const T* plane = m_current[field].data();
+    for (uint32_t ly = 0; ly < h; ++ly) {
+        std::copy_n(plane + m_layout.index(x0, y0 + ly), w, out + static_cast<size_t>(ly) * w);
+    }
+    return static_cast<size_t>(w) * h;
+}
+
+template <typename T, size_t N, typename S>
+void FieldSystem<T, N, S>::markChangedSpan(const T* before, const T* after, uint32_t count,
+                                           uint32_t x0, uint32_t y) {
+    const T threshold = m_changeThreshold;
+    for (uint32_t start = 0; start < count; ) {
+        // Walk one chunk-wide segment at a time
+        const uint32_t x = x0 + start;
+        const uint32_t end = std::min(count, start + (CHUNK_SIZE - (x & GridLayout::TILE_MASK)));
+        bool changed = false;
+        for (uint32_t i = start; i < end; ++i) {
+            changed |= std::abs(after[i] - before[i]) > threshold;
+        }
+        if (changed) markChunk(x, y);
+        start = end;
+    }
+}
+
+template <typename T, size_t N, typename S>
+void FieldSystem<T, N, S>::update() {
+    // Per-field coefficients with decay folded in: next = (1 - decay) * stencil(t) + source
+    std::vector<StencilCoefficients<S, T>> coeffs;
+    coeffs.reserve(N);
+    std::array<bool, N> active;
+    bool anyActive = false;
+    for (size_t f = 0; f < N; ++f) {
+        const FieldParams& p = m_params[f];
+        coeffs.emplace_back(p.diffusionRate, p.diffusionRate, 1.0 - p.decayRate);
+        active[f] = !isStatic(f);
+        anyActive |= active[f];
+    }
+    if (!anyActive) return;
+
+    if (!m_layout.isTiled()) {
+        const size_t stride = m_layout.rowStride();
+        for (size_t f = 0; f < N; ++f) {
+            if (active[f]) {
+                refreshGhostRing(m_current[f].data(), m_width, m_height, stride, m_params[f].boundary);
+            }
+        }
+
+        // Fused sweep: every active field for row y before moving to row y + 1
+        JobSystem::get().parallelFor(m_height, [&](size_t begin, size_t end, unsigned) {
+            for (size_t y = begin; y < end; ++y) {
+                const size_t row = m_layout.index(0, static_cast<uint32_t>(y));
+                for (size_t f = 0; f < N; ++f) {
+                    if (!active[f]) continue;
+                    const T* src = m_current[f].data() + row;
+                    T* dst = m_next[f].data() + row;
+                    diffuseRow<S>(src, dst, static_cast<std::ptrdiff_t>(stride), 0, m_width, coeffs[f]);
+                    if (!m_source[f].empty()) {
+                        const T* source = m_source[f].data() + row;
+                        for (uint32_t x = 0; x < m_width; ++x) {
+                            dst[x] += source[x];
+                        }
+                    }
+                    markChangedSpan(src, dst, m_width, 0, static_cast<uint32_t>(y));
+                }
+            }
+        }, bandGrain());
+    } else {
+        // Tiled: gather each field's tile plus halo in turn and run the row
+        // kernel on it; a tile is one dirty-tracking chunk
+        JobSystem::get().parallelFor(m_layout.tileCount(), [&](size_t begin, size_t end, unsigned) {
+            constexpr uint32_t HALO = GridLayout::HALO_TILE_SIZE;
+            T scratch[HALO * HALO];
+            for (size_t slot = begin; slot < end; ++slot) {
+                uint32_t tx, ty;
+                m_layout.tileAtSlot(slot, tx, ty);
+                const uint32_t x0 = tx << GridLayout::TILE_SHIFT;
+                const uint32_t y0 = ty << GridLayout::TILE_SHIFT;
+                const uint32_t w = std::min(GridLayout::TILE_SIZE, m_width - x0);
+                const uint32_t h = std::min(GridLayout::TILE_SIZE, m_height - y0);
+                const size_t base = slot * GridLayout::TILE_CELLS;
+
+                for (size_t f = 0; f < N; ++f) {
+                    if (!active[f]) continue;
+                    m_layout.gatherTileHalo(m_current[f].data(), tx, ty, m_params[f].boundary, scratch);
+                    for (uint32_t ly = 0; ly < h; ++ly) {
+                        const size_t row = base + (static_cast<size_t>(ly) << GridLayout::TILE_SHIFT);
+                        const T* src = scratch + (ly + 1) * HALO + 1;
+                        T* dst = m_next[f].data() + row;
+                        diffuseRow<S>(src, dst, HALO, 0, w, coeffs[f]);
+                        if (!m_source[f].empty()) {
+                            const T* source = m_source[f].data() + row;
+                            for (uint32_t x = 0; x < w; ++x) {
+                                dst[x] += source[x];
+                            }
+                        }
+                        markChangedSpan(src, dst, w, x0, y0 + ly);
+                    }
+                }
+            }
+        }, bandGrain());
+    }
+
+    for (size_t f = 0; f < N; ++f) {
+        if (active[f]) m_current[f].swap(m_next[f]);
+    }
+}
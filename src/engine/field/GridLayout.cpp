@@ -0,0 +1,32 @@
+#include "GridLayout.hpp"
+#include <algorithm>
+#include <numeric>
+
+GridLayout::GridLayout(Kind kind, uint32_t width, uint32_t height)
+    : m_kind(kind), m_width(width), m_height(height) {
+    if (m_kind == Kind::RowMajor) {
+        m_stride = static_cast<size_t>(width) + 2;
+        m_storageSize = m_stride * (static_cast<size_t>(height) + 2);
+        return;
+    }
+
+    m_tilesX = (width + TILE_MASK) >> TILE_SHIFT;
+    m_tilesY = (height + TILE_MASK) >> TILE_SHIFT;
+    m_storageSize = tileCount() * TILE_CELLS;
+
+    m_slotTile.resize(tileCount());
+    std::iota(m_slotTile.begin(), m_slotTile.end(), 0u);
+    if (m_kind == Kind::TiledMorton) {
+        // Rank tiles by Morton code; ranking (rather than using the code as the
+        // slot) keeps the plane dense when the tile grid is not a power of two
+        const uint32_t tilesX = m_tilesX;
+        std::stable_sort(m_slotTile.begin(), m_slotTile.end(), [tilesX](uint32_t a, uint32_t b) {
+            return mortonEncode2D(a % tilesX, a / tilesX) < mortonEncode2D(b % tilesX, b / tilesX);
+        });
+    }
+
+    m_tileSlot.resize(tileCount());
+    for (uint32_t slot = 0; slot < m_slotTile.size(); ++slot) {
+        m_tileSlot[m_slotTile[slot]] = slot;
+    }
+}
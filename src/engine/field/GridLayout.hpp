@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Boundary.hpp"
+
+// Interleave the low 16 bits of x and y into a Z-order (Morton) code.
+inline uint32_t mortonEncode2D(uint32_t x, uint32_t y) {
+    auto spread = [](uint32_t v) {
+        v &= 0x0000FFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+// Maps (x, y) cell coordinates to offsets in a flat field plane.
+//
+// RowMajor:    (width + 2) x (height + 2) rows with a one-cell ghost ring
+//              (see field/Boundary.hpp).
+// Tiled:       32x32 tiles, each stored contiguously, tiles in row-major order.
+// TiledMorton: as Tiled, but tiles are ordered along a Z-curve so tiles that
+//              are close in 2D are also close in memory.
+//
+// Tiled layouts have no ghost ring; kernels gather each tile plus a one-cell
+// halo into a scratch buffer and apply the boundary condition there. Edge
+// tiles are padded to the full 32x32; the padding is never read.
+class GridLayout {
+public:
+    enum class Kind : uint8_t {
+        RowMajor,
+        Tiled,
+        TiledMorton
+    };
+
+    static constexpr uint32_t TILE_SHIFT = 5;
+    static constexpr uint32_t TILE_SIZE = 1u << TILE_SHIFT;
+    static constexpr uint32_t TILE_MASK = TILE_SIZE - 1;
+    static constexpr size_t TILE_CELLS = static_cast<size_t>(TILE_SIZE) * TILE_SIZE;
+
+    // Row length of a gatherTileHalo() scratch buffer: one tile plus a
+    // one-cell halo on each side
+    static constexpr uint32_t HALO_TILE_SIZE = TILE_SIZE + 2;
+
+    GridLayout() = default;
+    GridLayout(Kind kind, uint32_t width, uint32_t height);
+
+    Kind getKind() const { return m_kind; }
+    bool isTiled() const { return m_kind != Kind::RowMajor; }
+    uint32_t getWidth() const { return m_width; }
+    uint32_t getHeight() const { return m_height; }
+
+    // Number of elements a plane in this layout needs
+    size_t storageSize() const { return m_storageSize; }
+
+    // Row length of a RowMajor plane (width + 2); 0 for tiled layouts
+    size_t rowStride() const { return m_stride; }
+
+    size_t index(uint32_t x, uint32_t y) const {
+        if (m_kind == Kind::RowMajor) {
+            return (static_cast<size_t>(y) + 1) * m_stride + x + 1;
+        }
+        return tileBase(x >> TILE_SHIFT, y >> TILE_SHIFT) +
+               (static_cast<size_t>(y & TILE_MASK) << TILE_SHIFT) + (x & TILE_MASK);
+    }
+
+    // Tile addressing (tiled layouts only). Tiles are numbered by their slot,
+    // i.e. their position in memory, so iterating slots walks the plane in order.
+    uint32_t tilesX() const { return m_tilesX; }
+    uint32_t tilesY() const { return m_tilesY; }
+    size_t tileCount() const { return static_cast<size_t>(m_tilesX) * m_tilesY; }
+    size_t tileBase(uint32_t tx, uint32_t ty) const {
+        return static_cast<size_t>(m_tileSlot[static_cast<size_t>(ty) * m_tilesX + tx]) * TILE_CELLS;
+    }
+    void tileAtSlot(size_t slot, uint32_t& tx, uint32_t& ty) const {
+        const uint32_t tile = m_slotTile[slot];
+        tx = tile % m_tilesX;
+        ty = tile / m_tilesX;
+    }
+
+    // Copy a plane to / from a dense row-major width x height array
+    template <typename T>
+    void gather(const T* plane, T* out) const;
+    template <typename T>
+    void scatter(const T* in, T* plane) const;
+
+    // Copy tile (tx, ty) plus its one-cell halo into `scratch`, a
+    // HALO_TILE_SIZE x HALO_TILE_SIZE buffer laid out like a RowMajor plane,
+    // filling halo cells past the map edge from `bc`. Tiled layouts only.
+    template <typename T>
+    void gatherTileHalo(const T* plane, uint32_t tx, uint32_t ty,
+                        const BoundaryCondition& bc, T* scratch) const;
+
+private:
+    Kind m_kind = Kind::RowMajor;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    size_t m_stride = 0;
+    size_t m_storageSize = 0;
+    uint32_t m_tilesX = 0;
+    uint32_t m_tilesY = 0;
+    std::vector<uint32_t> m_tileSlot;  // tile (ty * tilesX + tx) -> memory slot
+    std::vector<uint32_t> m_slotTile;  // memory slot -> tile
+};
+
+template <typename T>
+void GridLayout::gather(const T* plane, T* out) const {
+    if (m_kind == Kind::RowMajor) {
+        for (uint32_t y = 0; y < m_height; ++y) {
+            std::memcpy(out + static_cast<size_t>(y) * m_width, plane + index(0, y), m_width * sizeof(T));
+        }
+        return;
+    }
+
+    for (size_t slot = 0; slot < tileCount(); ++slot) {
+        uint32_t tx, ty;
+        tileAtSlot(slot, tx, ty);
+        const uint32_t x0 = tx << TILE_SHIFT;
+        const uint32_t y0 = ty << TILE_SHIFT;
+        const uint32_t w = std::min(TILE_SIZE, m_width - x0);
+        const uint32_t h = std::min(TILE_SIZE, m_height - y0);
+        const T* tile = plane + slot * TILE_CELLS;
+        for (uint32_t ly = 0; ly < h; ++ly) {
+            std::memcpy(out + static_cast<size_t>(y0 + ly) * m_width + x0,
+                        tile + (static_cast<size_t>(ly) << TILE_SHIFT), w * sizeof(T));
+        }
+    }
+}
+
+template <typename T>
+void GridLayout::scatter(const T* in, T* plane) const {
+    if (m_kind == Kind::RowMajor) {
+        for (uint32_t y = 0; y < m_height; ++y) {
+            std::memcpy(plane + index(0, y), in + static_cast<size_t>(y) * m_width, m_width * sizeof(T));
+        }
+        return;
+    }
+
+    for (size_t slot = 0; slot < tileCount(); ++slot) {
+        uint32_t tx, ty;
+        tileAtSlot(slot, tx, ty);
+        const uint32_t x0 = tx << TILE_SHIFT;
+        const uint32_t y0 = ty << TILE_SHIFT;
+        const uint32_t w = std::min(TILE_SIZE, m_width - x0);
+        const uint32_t h = std::min(TILE_SIZE, m_height - y0);
+        T* tile = plane + slot * TILE_CELLS;
+        for (uint32_t ly = 0; ly < h; ++ly) {
+            std::memcpy(tile + (static_cast<size_t>(ly) << TILE_SHIFT),
+                        in + static_cast<size_t>(y0 + ly) * m_width + x0, w * sizeof(T));
+        }
+    }
+}
+
+template <typename T>
+void GridLayout::gatherTileHalo(const T* plane, uint32_t tx, uint32_t ty,
+                                const BoundaryCondition& bc, T* scratch) const {
+    const uint32_t x0 = tx << TILE_SHIFT;
+    const uint32_t y0 = ty << TILE_SHIFT;
+    const uint32_t w = std::min(TILE_SIZE, m_width - x0);
+    const uint32_t h = std::min(TILE_SIZE, m_height - y0);
+
+    // Tile body: contiguous rows in the plane
+    const T* tile = plane + tileBase(tx, ty);
+    for (uint32_t ly = 0; ly < h; ++ly) {
+        std::memcpy(scratch + (ly + 1) * HALO_TILE_SIZE + 1,
+                    tile + (static_cast<size_t>(ly) << TILE_SHIFT), w * sizeof(T));
+    }
+
+    // Halo: neighbouring tiles, or the boundary condition past the map edge
+    auto fetch = [&](int x, int y) {
+        if (!resolveGhost(x, y, m_width, m_height, bc)) return static_cast<T>(bc.value);
+        return plane[index(static_cast<uint32_t>(x), static_cast<uint32_t>(y))];
+    };
+    const int left = static_cast<int>(x0) - 1;
+    const int top = static_cast<int>(y0) - 1;
+    for (uint32_t i = 0; i < w + 2; ++i) {
+        scratch[i] = fetch(left + static_cast<int>(i), top);
+        scratch[(h + 1) * HALO_TILE_SIZE + i] = fetch(left + static_cast<int>(i), top + static_cast<int>(h) + 1);
+    }
+    for (uint32_t ly = 1; ly <= h; ++ly) {
+        scratch[ly * HALO_TILE_SIZE] = fetch(left, top + static_cast<int>(ly));
+        scratch[ly * HALO_TILE_SIZE + w + 1] = fetch(left + static_cast<int>(w) + 1, top + static_cast<int>(ly));
+    }
+}
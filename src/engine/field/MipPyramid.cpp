@@ -0,0 +1,48 @@
+#include "MipPyramid.hpp"
+#include <algorithm>
+
+void MipPyramid::build(const double* base, uint32_t width, uint32_t height) {
+    if (width != m_baseWidth || height != m_baseHeight || m_levels.empty()) {
+        m_baseWidth = width;
+        m_baseHeight = height;
+        m_levels.clear();
+        uint32_t w = width, h = height;
+        for (;;) {
+            Level level;
+            level.width = w;
+            level.height = h;
+            level.values.resize(static_cast<size_t>(w) * h);
+            m_levels.push_back(std::move(level));
+            if (w <= 1 && h <= 1) break;
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+        }
+    }
+
+    std::copy(base, base + static_cast<size_t>(width) * height, m_levels[0].values.begin());
+
+    for (size_t l = 1; l < m_levels.size(); ++l) {
+        const Level& below = m_levels[l - 1];
+        Level& level = m_levels[l];
+        for (uint32_t y = 0; y < level.height; ++y) {
+            const uint32_t y0 = 2 * y;
+            const bool hasY1 = y0 + 1 < below.height;
+            const double* row0 = below.values.data() + static_cast<size_t>(y0) * below.width;
+            const double* row1 = hasY1 ? row0 + below.width : nullptr;
+            for (uint32_t x = 0; x < level.width; ++x) {
+                const uint32_t x0 = 2 * x;
+                const bool hasX1 = x0 + 1 < below.width;
+                double sum = row0[x0] + (hasX1 ? row0[x0 + 1] : 0.0);
+                if (row1) sum += row1[x0] + (hasX1 ? row1[x0 + 1] : 0.0);
+                level.values[static_cast<size_t>(y) * level.width + x] = sum;
+            }
+        }
+    }
+}
+
+uint32_t MipPyramid::cellCount(size_t level, uint32_t x, uint32_t y) const {
+    const uint32_t size = 1u << level;
+    const uint32_t w = std::min(size, m_baseWidth - std::min(m_baseWidth, x * size));
+    const uint32_t h = std::min(size, m_baseHeight - std::min(m_baseHeight, y * size));
+    return w * h;
+}
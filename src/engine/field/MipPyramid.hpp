@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sum pyramid over a dense row-major field.
+//
+// Level 0 is the field itself; each level above halves both dimensions
+// (rounding up) and stores the sum of the 2x2 block below it, so a node at
+// level l covers up to 2^l x 2^l base cells. The top level is a single node.
+// Divide by cellCount() for means.
+class MipPyramid {
+public:
+    MipPyramid() = default;
+
+    // (Re)build from a width x height field. Reuses storage when the size is
+    // unchanged.
+    void build(const double* base, uint32_t width, uint32_t height);
+
+    size_t levelCount() const { return m_levels.size(); }
+    uint32_t levelWidth(size_t level) const { return m_levels[level].width; }
+    uint32_t levelHeight(size_t level) const { return m_levels[level].height; }
+
+    double at(size_t level, uint32_t x, uint32_t y) const {
+        const Level& l = m_levels[level];
+        return l.values[static_cast<size_t>(y) * l.width + x];
+    }
+
+    // Number of base cells under node (x, y) of `level` (smaller at the edges)
+    uint32_t cellCount(size_t level, uint32_t x, uint32_t y) const;
+
+private:
+    struct Level {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<double> values;
+    };
+
+    std::vector<Level> m_levels;
+    uint32_t m_baseWidth = 0;
+    uint32_t m_baseHeight = 0;
+};
@@ -0,0 +1,246 @@
+#include "SparseField.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+float decayLog(float decayRate) {
+    const float keep = 1.0f - std::min(std::max(decayRate, 0.0f), 1.0f);
+    // A rate of 1 clears in one tick; keep the log finite
+    return keep > 0.0f ? std::log(keep) : -1e30f;
+}
+
+} // namespace
+
+SparseField::SparseField(uint32_t width, uint32_t height, float decayRate, float releaseThreshold)
+    : m_width(width), m_height(height),
+      m_defaultDecayLog(decayLog(decayRate)),
+      m_releaseThreshold(releaseThreshold) {}
+
+void SparseField::setLayerDecay(uint32_t layer, float decayRate) {
+    const float log = decayLog(decayRate);
+    auto it = m_layerDecayLog.find(layer);
+    const float previous = it != m_layerDecayLog.end() ? it->second : m_defaultDecayLog;
+    m_layerDecayLog[layer] = log;
+    if (log == previous) return;
+
+    // Live blocks carry their layer's rate: bring them up to date at the
+    // old rate, then switch them to the new one
+    for (const auto& entry : m_index) {
+        if ((entry.first >> 40) != layer) continue;
+        Block& block = m_blocks[entry.second];
+        catchUp(block);
+        block.decayLog = log;
+    }
+}
+
+float SparseField::getLayerDecay(uint32_t layer) const {
+    auto it = m_layerDecayLog.find(layer);
+    return 1.0f - std::exp(it != m_layerDecayLog.end() ? it->second : m_defaultDecayLog);
+}
+
+void SparseField::setTick(uint64_t tick) {
+    m_tick = std::max(m_tick, tick);
+}
+
+float SparseField::decayFactor(const Block& block) const {
+    if (block.updated == m_tick) return 1.0f;
+    return std::exp(block.decayLog * static_cast<float>(m_tick - block.updated));
+}
+
+const SparseField::Block* SparseField::findBlock(uint64_t key) const {
+    auto it = m_index.find(key);
+    return it != m_index.end() ? &m_blocks[it->second] : nullptr;
+}
+
+SparseField::Block& SparseField::acquireBlock(uint32_t layer, uint64_t key) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        Block& block = m_blocks[it->second];
+        catchUp(block);
+        return block;
+    }
+
+    uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(m_blocks.size());
+        m_blocks.emplace_back();
+    }
+    m_index.emplace(key, slot);
+
+    Block& block = m_blocks[slot];
+    std::fill(std::begin(block.values), std::end(block.values), 0.0f);
+    auto decay = m_layerDecayLog.find(layer);
+    block.decayLog = decay != m_layerDecayLog.end() ? decay->second : m_defaultDecayLog;
+    block.peak = 0.0f;
+    block.updated = m_tick;
+    block.key = key;
+    return block;
+}
+
+void SparseField::catchUp(Block& block) {
+    if (block.updated == m_tick) return;
+    const float factor = decayFactor(block);
+    for (float& v : block.values) {
+        v *= factor;
+    }
+    block.peak *= factor;
+    block.updated = m_tick;
+}
+
+void SparseField::releaseBlock(uint32_t slot) {
+    m_index.erase(m_blocks[slot].key);
+    m_blocks[slot].key = UINT64_MAX;
+    m_freeSlots.push_back(slot);
+}
+
+void SparseField::deposit(uint32_t layer, uint32_t x, uint32_t y, float amount) {
+    if (x >= m_width || y >= m_height) return;
+    Block& block = acquireBlock(layer, blockKey(layer, x >> BLOCK_SHIFT, y >> BLOCK_SHIFT));
+    float& v = block.values[((y & BLOCK_MASK) << BLOCK_SHIFT) | (x & BLOCK_MASK)];
+    v += amount;
+    block.peak = std::max(block.peak, std::abs(v));
+}
+
+float SparseField::get(uint32_t layer, uint32_t x, uint32_t y) const {
+    if (x >= m_width || y >= m_height) return 0.0f;
+    const Block* block = findBlock(blockKey(layer, x >> BLOCK_SHIFT, y >> BLOCK_SHIFT));
+    if (!block) return 0.0f;
+    return block->values[((y & BLOCK_MASK) << BLOCK_SHIFT) | (x & BLOCK_MASK)] * decayFactor(*block);
+}
+
+void SparseField::depositBatch(const Deposit* deposits, size_t count) {
+    // Sort by block so each block is found (or created) and caught up once
+    std::vector<uint32_t> order(count);
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Deposit& d = deposits[i];
+        keys[i] = blockKey(d.layer, d.x >> BLOCK_SHIFT, d.y >> BLOCK_SHIFT);
+    }
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    Block* block = nullptr;
+    uint64_t blockKeyValue = UINT64_MAX;
+    for (uint32_t i : order) {
+        const Deposit& d = deposits[i];
+        if (d.x >= m_width || d.y >= m_height) continue;
+        if (keys[i] != blockKeyValue) {
+            block = &acquireBlock(d.layer, keys[i]);
+            blockKeyValue = keys[i];
+        }
+        float& v = block->values[((d.y & BLOCK_MASK) << BLOCK_SHIFT) | (d.x & BLOCK_MASK)];
+        v += d.amount;
+        block->peak = std::max(block->peak, std::abs(v));
+    }
+}
+
+float SparseField::cellValue(uint32_t layer, int x, int y) const {
+    if (x < 0 || y < 0 || x >= static_cast<int>(m_width) || y >= static_cast<int>(m_height)) return 0.0f;
+    return get(layer, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+}
+
+float SparseField::sample(uint32_t layer, float x, float y) const {
+    const float fx = x - 0.5f;
+    const float fy = y - 0.5f;
+    const int x0 = static_cast<int>(std::floor(fx));
+    const int y0 = static_cast<int>(std::floor(fy));
+    const float tx = fx - x0;
+    const float ty = fy - y0;
+
+    const float top = cellValue(layer, x0, y0) * (1.0f - tx) + cellValue(layer, x0 + 1, y0) * tx;
+    const float bottom = cellValue(layer, x0, y0 + 1) * (1.0f - tx) + cellValue(layer, x0 + 1, y0 + 1) * tx;
+    return top * (1.0f - ty) + bottom * ty;
+}
+
+void SparseField::sampleBatch(const Probe* probes, size_t count, float* out) const {
+    // Visit probes grouped by the block of their top-left tap. A probe reads
+    // up to four blocks; the last few lookups are cached, so probes sharing a
+    // block (a creature's sensors, a flock) resolve it once.
+    std::vector<uint32_t> order(count);
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        const int x0 = std::max(0, static_cast<int>(std::floor(probes[i].x - 0.5f)));
+        const int y0 = std::max(0, static_cast<int>(std::floor(probes[i].y - 0.5f)));
+        keys[i] = blockKey(probes[i].layer, static_cast<uint32_t>(x0) >> BLOCK_SHIFT,
+                           static_cast<uint32_t>(y0) >> BLOCK_SHIFT);
+    }
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    struct CachedBlock {
+        uint64_t key = UINT64_MAX;
+        const Block* block = nullptr;
+        float factor = 0.0f;
+    };
+    CachedBlock cache[4];
+    unsigned nextEvict = 0;
+
+    auto cell = [&](uint32_t layer, int x, int y) -> float {
+        if (x < 0 || y < 0 || x >= static_cast<int>(m_width) || y >= static_cast<int>(m_height)) return 0.0f;
+        const uint64_t key = blockKey(layer, static_cast<uint32_t>(x) >> BLOCK_SHIFT,
+                                      static_cast<uint32_t>(y) >> BLOCK_SHIFT);
+        const CachedBlock* hit = nullptr;
+        for (const CachedBlock& c : cache) {
+            if (c.key == key) { hit = &c; break; }
+        }
+        if (!hit) {
+            CachedBlock& slot = cache[nextEvict++ & 3];
+            slot.key = key;
+            slot.block = findBlock(key);
+            slot.factor = slot.block ? decayFactor(*slot.block) : 0.0f;
+            hit = &slot;
+        }
+        if (!hit->block) return 0.0f;
+        return hit->block->values[((static_cast<uint32_t>(y) & BLOCK_MASK) << BLOCK_SHIFT) |
+                                  (static_cast<uint32_t>(x) & BLOCK_MASK)] * hit->factor;
+    };
+
+    for (uint32_t i : order) {
+        const Probe& p = probes[i];
+        const float fx = p.x - 0.5f;
+        const float fy = p.y - 0.5f;
+        const int x0 = static_cast<int>(std::floor(fx));
+        const int y0 = static_cast<int>(std::floor(fy));
+        const float tx = fx - x0;
+        const float ty = fy - y0;
+
+        const float top = cell(p.layer, x0, y0) * (1.0f - tx) + cell(p.layer, x0 + 1, y0) * tx;
+        const float bottom = cell(p.layer, x0, y0 + 1) * (1.0f - tx) + cell(p.layer, x0 + 1, y0 + 1) * tx;
+        out[i] = top * (1.0f - ty) + bottom * ty;
+    }
+}
+
+size_t SparseField::collect(size_t maxBlocks) {
+    size_t freed = 0;
+    const size_t total = m_blocks.size();
+    const size_t visits = std::min(maxBlocks, total);
+    for (size_t n = 0; n < visits; ++n) {
+        if (m_collectCursor >= total) m_collectCursor = 0;
+        const uint32_t slot = static_cast<uint32_t>(m_collectCursor++);
+        const Block& block = m_blocks[slot];
+        if (block.key == UINT64_MAX) continue;  // Already free
+        if (block.peak * decayFactor(block) < m_releaseThreshold) {
+            releaseBlock(slot);
+            ++freed;
+        }
+    }
+    return freed;
+}
+
+void SparseField::clear() {
+    m_index.clear();
+    m_blocks.clear();
+    m_freeSlots.clear();
+    m_collectCursor = 0;
+}
+
+size_t SparseField::getMemoryUsage() const {
+    // Blocks plus a rough per-entry cost for the hash index
+    return m_blocks.capacity() * sizeof(Block) +
+           m_index.size() * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void*));
+}
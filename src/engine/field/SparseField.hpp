@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Sparse, exponentially decaying scalar field for scent trails and pheromones.
+//
+// Trails touch a tiny fraction of the map, so instead of a dense plane the
+// field is a hash of 8x8-cell blocks that exist only where something was
+// deposited. A field holds many independent layers (one per species, signal,
+// ...); the layer is part of the block key, so an empty layer costs nothing.
+//
+// Decay is lazy: each block remembers the tick its values were last brought
+// up to date, and readers scale by decay^(now - then). Writers catch the
+// block up before adding. collect() frees blocks whose peak has decayed below
+// the release threshold, so the working set follows the live trails.
+//
+// Values do not diffuse; sample() interpolates between cells instead.
+class SparseField {
+public:
+    static constexpr uint32_t BLOCK_SHIFT = 3;
+    static constexpr uint32_t BLOCK_SIZE = 1u << BLOCK_SHIFT;
+    static constexpr uint32_t BLOCK_MASK = BLOCK_SIZE - 1;
+    static constexpr uint32_t BLOCK_CELLS = BLOCK_SIZE * BLOCK_SIZE;
+
+    struct Deposit {
+        uint32_t layer;
+        uint32_t x;
+        uint32_t y;
+        float amount;
+    };
+
+    struct Probe {
+        uint32_t layer;
+        float x;   // Cell coordinates; cell centres are at integer + 0.5
+        float y;
+    };
+
+    // `decayRate` is the fraction lost per tick for layers without their own
+    // rate; blocks whose largest value drops below `releaseThreshold` are freed
+    SparseField(uint32_t width, uint32_t height, float decayRate = 0.02f,
+                float releaseThreshold = 1e-3f);
+
+    uint32_t getWidth() const { return m_width; }
+    uint32_t getHeight() const { return m_height; }
+
+    // Change a layer's decay rate. Decay up to the current tick is applied
+    // at the old rate; the new rate holds from then on, for live blocks too.
+    void setLayerDecay(uint32_t layer, float decayRate);
+    float getLayerDecay(uint32_t layer) const;
+
+    // Simulation clock used for lazy decay. Never goes backwards.
+    void setTick(uint64_t tick);
+    uint64_t getTick() const { return m_tick; }
+
+    void deposit(uint32_t layer, uint32_t x, uint32_t y, float amount);
+    float get(uint32_t layer, uint32_t x, uint32_t y) const;
+
+    // Batched variants: requests are grouped by block, so each block is
+    // looked up and caught up once per batch however many requests hit it.
+    // `out` receives one value per probe, in probe order.
+    void depositBatch(const Deposit* deposits, size_t count);
+    void sampleBatch(const Probe* probes, size_t count, float* out) const;
+
+    // Bilinear sample of one layer
+    float sample(uint32_t layer, float x, float y) const;
+
+    // Free blocks that have decayed below the release threshold. Visits at
+    // most `maxBlocks` blocks per call, resuming where the last call stopped,
+    // so the cost can be spread over ticks. Returns the number freed.
+    size_t collect(size_t maxBlocks = SIZE_MAX);
+
+    void clear();
+
+    size_t getBlockCount() const { return m_index.size(); }
+    size_t getMemoryUsage() const;
+
+private:
+    struct Block {
+        float values[BLOCK_CELLS];
+        float peak;          // Largest magnitude as of `updated`
+        float decayLog;      // ln(1 - decay rate) of the block's layer
+        uint64_t updated;    // Tick the values were last brought up to date
+        uint64_t key;        // Hash key, for collect()
+    };
+
+    static uint64_t blockKey(uint32_t layer, uint32_t bx, uint32_t by) {
+        return (static_cast<uint64_t>(layer) << 40) | (static_cast<uint64_t>(by) << 20) | bx;
+    }
+
+    // Scale applied to values stored at `updated` to read them now
+    float decayFactor(const Block& block) const;
+
+    const Block* findBlock(uint64_t key) const;
+    Block& acquireBlock(uint32_t layer, uint64_t key);
+    void catchUp(Block& block);
+    void releaseBlock(uint32_t slot);
+
+    float cellValue(uint32_t layer, int x, int y) const;
+
+    uint32_t m_width;
+    uint32_t m_height;
+    float m_defaultDecayLog;
+    float m_releaseThreshold;
+    uint64_t m_tick = 0;
+
+    std::unordered_map<uint32_t, float> m_layerDecayLog;  // Layers with their own decay rate
+    std::unordered_map<uint64_t, uint32_t> m_index;       // Block key -> slot in m_blocks
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_freeSlots;
+    size_t m_collectCursor = 0;
+};
@@ -0,0 +1,93 @@
+#include "SpectralDiffusion.hpp"
+#include "../core/JobSystem.hpp"
+#include <cmath>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Index of cos(d * k * 2 pi / n) in a table of cos(j * 2 pi / n)
+size_t wrapIndex(int d, uint32_t k, uint32_t n) {
+    const int64_t j = (static_cast<int64_t>(d) * k) % static_cast<int64_t>(n);
+    return static_cast<size_t>(j < 0 ? j + n : j);
+}
+
+} // namespace
+
+SpectralDiffusion::SpectralDiffusion(uint32_t width, uint32_t height)
+    : m_width(width), m_height(height), m_rowPlan(width), m_columnPlan(height),
+      m_cosX(width), m_cosY(height) {
+    for (uint32_t k = 0; k < width; ++k) {
+        m_cosX[k] = std::cos(2.0 * PI * k / width);
+    }
+    for (uint32_t k = 0; k < height; ++k) {
+        m_cosY[k] = std::cos(2.0 * PI * k / height);
+    }
+}
+
+void SpectralDiffusion::advance(double* field, double ticks, double centre, const std::vector<Tap>& taps) {
+    if (m_width == 0 || m_height == 0) return;
+
+    transform(field);
+
+    // Both transforms together scale by width * height; fold that in here
+    const double norm = 1.0 / (static_cast<double>(m_width) * m_height);
+    const bool integral = ticks == std::floor(ticks);
+
+    JobSystem::get().parallelFor(m_height, [&](size_t begin, size_t end, unsigned) {
+        for (size_t ky = begin; ky < end; ++ky) {
+            double* row = field + ky * m_width;
+            for (uint32_t kx = 0; kx < m_width; ++kx) {
+                double symbol = centre;
+                for (const Tap& tap : taps) {
+                    symbol += tap.coeff * m_cosX[wrapIndex(tap.dx, kx, m_width)] *
+                              m_cosY[wrapIndex(tap.dy, static_cast<uint32_t>(ky), m_height)];
+                }
+                // A negative symbol (rates beyond the stable range) only has a
+                // real power for whole steps; otherwise treat the mode as gone
+                if (symbol < 0.0 && !integral) symbol = 0.0;
+                row[kx] *= std::pow(symbol, ticks) * norm;
+            }
+        }
+    }, 8);
+
+    transform(field);
+}
+
+void SpectralDiffusion::transform(double* field) {
+    const uint32_t width = m_width;
+    const uint32_t height = m_height;
+
+    // Rows, two per complex FFT
+    const size_t rowPairs = (height + 1) / 2;
+    JobSystem::get().parallelFor(rowPairs, [&](size_t begin, size_t end, unsigned) {
+        FFTPlan::Workspace ws;
+        for (size_t p = begin; p < end; ++p) {
+            double* a = field + (2 * p) * width;
+            double* b = 2 * p + 1 < height ? a + width : nullptr;
+            m_rowPlan.hartleyPair(a, b, ws);
+        }
+    }, 4);
+
+    // Columns: gather a pair into contiguous scratch, transform, scatter back
+    const size_t columnPairs = (width + 1) / 2;
+    JobSystem::get().parallelFor(columnPairs, [&](size_t begin, size_t end, unsigned) {
+        FFTPlan::Workspace ws;
+        std::vector<double> a(height), b(height);
+        for (size_t p = begin; p < end; ++p) {
+            const size_t x = 2 * p;
+            const bool pair = x + 1 < width;
+            for (uint32_t y = 0; y < height; ++y) {
+                const double* row = field + static_cast<size_t>(y) * width;
+                a[y] = row[x];
+                if (pair) b[y] = row[x + 1];
+            }
+            m_columnPlan.hartleyPair(a.data(), pair ? b.data() : nullptr, ws);
+            for (uint32_t y = 0; y < height; ++y) {
+                double* row = field + static_cast<size_t>(y) * width;
+                row[x] = a[y];
+                if (pair) row[x + 1] = b[y];
+            }
+        }
+    }, 4);
+}
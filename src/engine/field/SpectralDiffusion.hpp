@@ -0,0 +1,46 @@
+#pragma once
+
+#include "FFT.hpp"
+#include <cstdint>
+#include <vector>
+
+// Exact long-interval integrator for linear diffusion on a periodic grid.
+//
+// One explicit stencil step multiplies every Fourier mode (kx, ky) by the
+// stencil's symbol
+//     s(kx, ky) = centre + sum_i coeff_i * cos(dx_i * wx) * cos(dy_i * wy),
+// so `ticks` steps multiply it by s^ticks. advance() applies that directly:
+// a 2D real-to-real (Hartley) transform, a pointwise multiply and the inverse
+// transform, O(N log N) however far forward it jumps. Fractional tick counts
+// interpolate smoothly between steps.
+//
+// Taps must be mirror-symmetric in both axes (true for every stencil in
+// field/Stencil.hpp); that is what makes the Hartley transform diagonalize the
+// step. Row and column passes run on the JobSystem.
+class SpectralDiffusion {
+public:
+    struct Tap {
+        int dx;
+        int dy;
+        double coeff;
+    };
+
+    SpectralDiffusion(uint32_t width, uint32_t height);
+
+    uint32_t getWidth() const { return m_width; }
+    uint32_t getHeight() const { return m_height; }
+
+    // Advance a dense row-major width x height field in place
+    void advance(double* field, double ticks, double centre, const std::vector<Tap>& taps);
+
+private:
+    // Separable 2D Hartley transform; applying it twice scales by width * height
+    void transform(double* field);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    FFTPlan m_rowPlan;
+    FFTPlan m_columnPlan;
+    std::vector<double> m_cosX;  // cos(2 pi k / width)
+    std::vector<double> m_cosY;  // cos(2 pi k / height)
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Compile-time diffusion stencils.
+//
+// A stencil is a struct with a constexpr `taps` table of neighbour offsets and
+// weights (weights sum to 1, so the weighted sum is the neighbourhood average a
+// cell relaxes towards). Kernels take the stencil as a template parameter, so
+// the tap loop is unrolled at compile time and the per-row x loop is a plain
+// contiguous sweep the compiler can vectorize.
+
+enum class StencilAxis : uint8_t {
+    X,     // Tap lies along the x axis and uses the x diffusion rate
+    Y,     // Tap lies along the y axis and uses the y diffusion rate
+    Both   // Diagonal tap, uses the mean of both rates
+};
+
+struct StencilTap {
+    int dx;
+    int dy;
+    double weight;
+    StencilAxis axis;
+};
+
+// Classic 5-point stencil: the four edge-adjacent neighbours.
+struct FivePointStencil {
+    static constexpr bool isotropic = true;
+    static constexpr std::size_t size = 4;
+    static constexpr StencilTap taps[size] = {
+        { 0,  1, 0.25, StencilAxis::Y},
+        { 1,  0, 0.25, StencilAxis::X},
+        { 0, -1, 0.25, StencilAxis::Y},
+        {-1,  0, 0.25, StencilAxis::X}
+    };
+};
+
+// Isotropic 9-point stencil (edges 4/20, corners 1/20). Removes most of the
+// axis-aligned "diamond" artefact the 5-point stencil leaves on point sources.
+struct NinePointStencil {
+    static constexpr bool isotropic = true;
+    static constexpr std::size_t size = 8;
+    static constexpr StencilTap taps[size] = {
+        { 0,  1, 0.20, StencilAxis::Y},
+        { 1,  0, 0.20, StencilAxis::X},
+        { 0, -1, 0.20, StencilAxis::Y},
+        {-1,  0, 0.20, StencilAxis::X},
+        { 1,  1, 0.05, StencilAxis::Both},
+        { 1, -1, 0.05, StencilAxis::Both},
+        {-1, -1, 0.05, StencilAxis::Both},
+        {-1,  1, 0.05, StencilAxis::Both}
+    };
+};
+
+// 5-point offsets with independent x and y diffusion rates (layered rock,
+// prevailing wind). Offsets are still compile-time; only the two rates vary.
+struct AnisotropicStencil {
+    static constexpr bool isotropic = false;
+    static constexpr std::size_t size = 4;
+    static constexpr StencilTap taps[size] = {
+        { 0,  1, 0.25, StencilAxis::Y},
+        { 1,  0, 0.25, StencilAxis::X},
+        { 0, -1, 0.25, StencilAxis::Y},
+        {-1,  0, 0.25, StencilAxis::X}
+    };
+};
+
+// Per-tick tap coefficients: stencil weight times the rate for the tap's axis.
+// `centre` is 1 - sum(coeff), so next = centre * t + sum(coeff[i] * n[i]).
+// T is the field's value type, so float fields keep float arithmetic.
+template <typename S, typename T = double>
+struct StencilCoefficients {
+    T coeff[S::size];
+    T centre;
+
+    StencilCoefficients(double rateX, double rateY, double scale = 1.0) {
+        double total = 0.0;
+        for (std::size_t i = 0; i < S::size; ++i) {
+            double rate = rateX;
+            if (!S::isotropic) {
+                switch (S::taps[i].axis) {
+                    case StencilAxis::X:    rate = rateX; break;
+                    case StencilAxis::Y:    rate = rateY; break;
+                    case StencilAxis::Both: rate = 0.5 * (rateX + rateY); break;
+                }
+            }
+            const double c = S::taps[i].weight * rate;
+            coeff[i] = static_cast<T>(c * scale);
+            total += c;
+        }
+        centre = static_cast<T>((1.0 - total) * scale);
+    }
+};
+
+namespace StencilDetail {
+
+template <typename S, typename T, std::size_t... I>
+inline T applyTaps(const T* p, std::ptrdiff_t stride,
+                   const T* coeff, std::index_sequence<I...>) {
+    return ((coeff[I] * p[S::taps[I].dy * stride + S::taps[I].dx]) + ...);
+}
+
+} // namespace StencilDetail
+
+// Relax cells [x0, x1) of one row. `src` and `dst` point at the start of the
+// row; every tap of every cell in the range must be addressable (callers run
+// this on interior cells only, or on a padded buffer).
+template <typename S, typename T>
+inline void diffuseRow(const T* __restrict src, T* __restrict dst,
+                       std::ptrdiff_t stride, uint32_t x0, uint32_t x1,
+                       const StencilCoefficients<S, T>& c) {
+    const T centre = c.centre;
+    for (uint32_t x = x0; x < x1; ++x) {
+        dst[x] = centre * src[x] +
+                 StencilDetail::applyTaps<S>(src + x, stride, c.coeff,
+                                             std::make_index_sequence<S::size>{});
+    }
+}
+
+// True if any tap moves an odd distance along both axes. Such stencils couple
+// same-coloured cells of a red-black checkerboard, so in-place updates need
+// four colours (x and y parity) instead of two.
+template <typename S>
+constexpr bool hasDiagonalTaps() {
+    for (std::size_t i = 0; i < S::size; ++i) {
+        if ((S::taps[i].dx & 1) && (S::taps[i].dy & 1)) return true;
+    }
+    return false;
+}
+
+// In-place variant of diffuseRow for multi-colour Gauss-Seidel: relaxes
+// cells x0, x0 + 2, ... < x1 of `row`. Safe only when no tap of those cells
+// reads a cell of the same colour.
+template <typename S, typename T>
+inline void relaxRowInPlace(T* row, std::ptrdiff_t stride, uint32_t x0, uint32_t x1,
+                            const StencilCoefficients<S, T>& c) {
+    const T centre = c.centre;
+    for (uint32_t x = x0; x < x1; x += 2) {
+        row[x] = centre * row[x] +
+                 StencilDetail::applyTaps<S>(row + x, stride, c.coeff,
+                                             std::make_index_sequence<S::size>{});
+    }
+}
@@ -0,0 +1,143 @@
+#include "BehaviourLibrary.hpp"
+#include "core/JobSystem.hpp"
+#include <cstring>
+
+namespace {
+
+// Creatures per job; small enough to balance, large enough to amortize
+constexpr size_t CREATURE_GRAIN = 256;
+
+uint64_t hashProgram(const BehaviourProgram& program) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(program.code.data());
+    const size_t size = program.code.size() * sizeof(BehaviourInstruction);
+    uint64_t h = 14695981039346656037ull;  // FNV-1a
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ bytes[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+bool sameCode(const BehaviourProgram& a, const BehaviourProgram& b) {
+    return a.code.size() == b.code.size() &&
+           std::memcmp(a.code.data(), b.code.data(), a.code.size() * sizeof(BehaviourInstruction)) == 0;
+}
+
+} // namespace
+
+BehaviourLibrary::ProgramId BehaviourLibrary::programFor(const GenomeStore& store,
+                                                         GenomeStore::GenomeId genome) {
+    if (!store.isValid(genome)) return NO_PROGRAM;
+    if (genome >= m_byGenome.size()) {
+        m_byGenome.resize(static_cast<size_t>(genome) + 1);
+    }
+
+    CachedGenome& cached = m_byGenome[genome];
+    const uint16_t generation = store.getGeneration(genome);
+    if (cached.program != NO_PROGRAM) {
+        if (cached.generation == generation) return cached.program;
+        release(cached.program);  // The id now names a different genome
+    }
+
+    store.materialize(genome, m_dna);
+    cached.program = intern(BehaviourVM::decode(m_dna.data(), m_dna.size()));
+    cached.generation = generation;
+    return cached.program;
+}
+
+void BehaviourLibrary::sweep(const GenomeStore& store) {
+    for (GenomeStore::GenomeId genome = 0; genome < m_byGenome.size(); ++genome) {
+        CachedGenome& cached = m_byGenome[genome];
+        if (cached.program == NO_PROGRAM) continue;
+        if (store.isValid(genome) && store.getGeneration(genome) == cached.generation) continue;
+        release(cached.program);
+        cached = CachedGenome();
+    }
+}
+
+BehaviourLibrary::ProgramId BehaviourLibrary::intern(BehaviourProgram&& program) {
+    const uint64_t hash = hashProgram(program);
+    auto range = m_byHash.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        Entry& e = m_programs[it->second];
+        if (sameCode(e.program, program)) {
+            ++e.refs;
+            return it->second;
+        }
+    }
+
+    ProgramId id;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+    } else {
+        id = static_cast<ProgramId>(m_programs.size());
+        m_programs.emplace_back();
+    }
+    Entry& e = m_programs[id];
+    e.program = std::move(program);
+    e.hash = hash;
+    e.refs = 1;
+    m_byHash.emplace(hash, id);
+    ++m_liveCount;
+    return id;
+}
+
+void BehaviourLibrary::release(ProgramId id) {
+    Entry& e = m_programs[id];
+    if (--e.refs > 0) return;
+
+    auto range = m_byHash.equal_range(e.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == id) {
+            m_byHash.erase(it);
+            break;
+        }
+    }
+    e = Entry();
+    m_free.push_back(id);
+    --m_liveCount;
+}
+
+uint64_t BehaviourLibrary::runBatch(const ProgramId* programs, size_t count, const float* inputs,
+                                    float* outputs, uint32_t budget) {
+    // Counting sort of creatures by program
+    m_offsets.assign(m_programs.size() + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (programs[i] != NO_PROGRAM) ++m_offsets[programs[i] + 1];
+    }
+    for (size_t p = 1; p < m_offsets.size(); ++p) {
+        m_offsets[p] += m_offsets[p - 1];
+    }
+    m_order.resize(m_offsets.back());
+    for (size_t i = 0; i < count; ++i) {
+        if (programs[i] != NO_PROGRAM) m_order[m_offsets[programs[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    auto& jobs = JobSystem::get();
+    m_executed.assign(jobs.getWorkerCount(), 0);
+    jobs.parallelFor(m_order.size(), [&](size_t begin, size_t end, unsigned worker) {
+        uint64_t executed = 0;
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t creature = m_order[k];
+            executed += BehaviourVM::run(m_programs[programs[creature]].program,
+                                         inputs + static_cast<size_t>(creature) * BehaviourVM::INPUT_COUNT,
+                                         outputs + static_cast<size_t>(creature) * BehaviourVM::OUTPUT_COUNT,
+                                         budget);
+        }
+        m_executed[worker] += executed;
+    }, CREATURE_GRAIN);
+
+    uint64_t total = 0;
+    for (uint64_t executed : m_executed) {
+        total += executed;
+    }
+    return total;
+}
+
+void BehaviourLibrary::clear() {
+    m_byGenome.clear();
+    m_programs.clear();
+    m_free.clear();
+    m_byHash.clear();
+    m_liveCount = 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "BehaviourVM.hpp"
+#include "GenomeStore.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Behaviour programs decoded from genomes, cached per genome and shared
+// between genomes that decode to the same code.
+//
+// programFor() decodes a genome the first time it is asked for and then
+// answers from a table indexed by genome id (checked against the store's
+// generation, so reused ids are decoded afresh). Programs are reference
+// counted by the cached genomes using them and freed once none do; a
+// genome's cache entry goes when its id is reused or sweep() finds the
+// genome released.
+//
+// runBatch() runs one program per creature. Creatures are ordered by
+// program first, so each program's code stays in cache while every
+// creature using it runs, and the sorted list is split across the job
+// system. Not thread-safe apart from runBatch()'s internal workers.
+class BehaviourLibrary {
+public:
+    using ProgramId = uint32_t;
+    static constexpr ProgramId NO_PROGRAM = 0xFFFFFFFFu;
+
+    ProgramId programFor(const GenomeStore& store, GenomeStore::GenomeId genome);
+
+    const BehaviourProgram& getProgram(ProgramId id) const { return m_programs[id].program; }
+    size_t getProgramCount() const { return m_liveCount; }
+
+    // `inputs` holds INPUT_COUNT sensors per creature and `outputs` gets
+    // OUTPUT_COUNT actuators per creature; programs[i] may be NO_PROGRAM
+    // (outputs left alone). Returns the instructions executed.
+    uint64_t runBatch(const ProgramId* programs, size_t count, const float* inputs, float* outputs,
+                      uint32_t budget);
+
+    // Drop cached genomes that `store` has since released (or reused the id
+    // of), freeing programs no live genome uses. Call it every so often,
+    // e.g. after a batch of deaths; ids of freed programs may be reused.
+    void sweep(const GenomeStore& store);
+
+    // Forget everything; needed when the genome store is cleared or loaded
+    void clear();
+
+private:
+    struct CachedGenome {
+        ProgramId program = NO_PROGRAM;
+        uint16_t generation = 0;
+    };
+
+    struct Entry {
+        BehaviourProgram program;
+        uint64_t hash = 0;
+        uint32_t refs = 0;   // 0 = free slot
+    };
+
+    ProgramId intern(BehaviourProgram&& program);
+    void release(ProgramId id);
+
+    std::vector<CachedGenome> m_byGenome;
+    std::vector<Entry> m_programs;
+    std::vector<ProgramId> m_free;
+    std::unordered_multimap<uint64_t, ProgramId> m_byHash;
+    size_t m_liveCount = 0;
+
+    // Scratch
+    std::vector<uint8_t> m_dna;
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint64_t> m_executed;   // Per worker
+};
@@ -0,0 +1,233 @@
+#include "BehaviourVM.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Threaded dispatch (a jump table of label addresses) where the compiler
+// supports it; WASM has no indirect goto, and a dense switch is what
+// compiles best there
+#ifndef BEHAVIOUR_VM_THREADED
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__EMSCRIPTEN__)
+#define BEHAVIOUR_VM_THREADED 1
+#else
+#define BEHAVIOUR_VM_THREADED 0
+#endif
+#endif
+
+namespace BehaviourVM {
+
+namespace {
+
+constexpr float DIV_EPSILON = 1e-6f;
+
+BehaviourInstruction makeInstruction(BehaviourOp op, uint8_t a = 0, uint8_t b = 0, uint8_t c = 0) {
+    BehaviourInstruction in;
+    std::memset(&in, 0, sizeof(in));  // Identical programs compare equal bytewise
+    in.op = op;
+    in.a = a;
+    in.b = b;
+    in.c = c;
+    return in;
+}
+
+bool isBinary(BehaviourOp op) {
+    switch (op) {
+        case BehaviourOp::Add:
+        case BehaviourOp::Sub:
+        case BehaviourOp::Mul:
+        case BehaviourOp::Div:
+        case BehaviourOp::Min:
+        case BehaviourOp::Max:
+        case BehaviourOp::Less:
+        case BehaviourOp::Select:
+            return true;
+        default:
+            return false;
+    }
+}
+
+float clampOutput(float v) {
+    // NaN fails every comparison and lands on 0
+    return v > 1.0f ? 1.0f : (v < -1.0f ? -1.0f : (v == v ? v : 0.0f));
+}
+
+} // namespace
+
+BehaviourProgram decode(const uint8_t* dna, size_t size) {
+    const size_t length = std::min(size / CODON_SIZE, MAX_PROGRAM_LENGTH - 1);
+    BehaviourProgram program;
+    program.code.reserve(length + 1);
+
+    for (size_t i = 0; i < length; ++i) {
+        const uint8_t* codon = dna + i * CODON_SIZE;
+        const auto op = static_cast<BehaviourOp>(codon[0] % static_cast<uint8_t>(BehaviourOp::Count));
+        const uint8_t a = codon[1] % REGISTER_COUNT;
+        BehaviourInstruction in = makeInstruction(op, a);
+
+        switch (op) {
+            case BehaviourOp::Const:
+                // Signed 8.8 fixed point: +-128 in steps of 1/256
+                in.imm = static_cast<float>(static_cast<int16_t>(codon[2] << 8 | codon[3])) / 256.0f;
+                break;
+            case BehaviourOp::Input:
+                in.b = codon[2] % INPUT_COUNT;
+                break;
+            case BehaviourOp::Output:
+                in.b = codon[2] % OUTPUT_COUNT;
+                break;
+            case BehaviourOp::Jump:
+            case BehaviourOp::JumpIf: {
+                // Signed offset from the next instruction; the appended Halt
+                // is the furthest a jump can go
+                const long target = static_cast<long>(i) + 1 + static_cast<int8_t>(codon[2]);
+                in.target = static_cast<uint32_t>(std::clamp<long>(target, 0, static_cast<long>(length)));
+                break;
+            }
+            default:
+                in.b = codon[2] % REGISTER_COUNT;
+                if (isBinary(op)) in.c = codon[3] % REGISTER_COUNT;
+                break;
+        }
+        program.code.push_back(in);
+    }
+
+    program.code.push_back(makeInstruction(BehaviourOp::Halt));
+    return program;
+}
+
+bool verify(const BehaviourProgram& program) {
+    const auto& code = program.code;
+    if (code.empty() || code.size() > MAX_PROGRAM_LENGTH || code.back().op != BehaviourOp::Halt) {
+        return false;
+    }
+    for (const BehaviourInstruction& in : code) {
+        if (in.op >= BehaviourOp::Count || in.a >= REGISTER_COUNT) return false;
+        switch (in.op) {
+            case BehaviourOp::Halt:
+            case BehaviourOp::Const:
+                break;
+            case BehaviourOp::Input:
+                if (in.b >= INPUT_COUNT) return false;
+                break;
+            case BehaviourOp::Output:
+                if (in.b >= OUTPUT_COUNT) return false;
+                break;
+            case BehaviourOp::Jump:
+            case BehaviourOp::JumpIf:
+                if (in.target >= code.size()) return false;
+                break;
+            default:
+                if (in.b >= REGISTER_COUNT || in.c >= REGISTER_COUNT) return false;
+                break;
+        }
+    }
+    return true;
+}
+
+uint32_t run(const BehaviourProgram& program, const float* inputs, float* outputs, uint32_t budget) {
+    float r[REGISTER_COUNT] = {};
+    const BehaviourInstruction* const code = program.code.data();
+    const BehaviourInstruction* ip = code;
+    const BehaviourInstruction* stretch = code;  // Start of the current straight run
+    uint32_t executed = 0;
+
+#if BEHAVIOUR_VM_THREADED
+    // Same order as BehaviourOp
+    static const void* const s_labels[] = {
+        &&op_Halt, &&op_Const, &&op_Move, &&op_Add, &&op_Sub, &&op_Mul, &&op_Div,
+        &&op_Min, &&op_Max, &&op_Abs, &&op_Neg, &&op_Tanh, &&op_Less, &&op_Select,
+        &&op_Input, &&op_Output, &&op_Jump, &&op_JumpIf
+    };
+    static_assert(sizeof(s_labels) / sizeof(s_labels[0]) == static_cast<size_t>(BehaviourOp::Count),
+                  "Dispatch table out of sync with BehaviourOp");
+#define VM_OP(name) op_##name:
+#define VM_DISPATCH() goto *s_labels[static_cast<uint8_t>(ip->op)]
+#else
+#define VM_OP(name) case BehaviourOp::name:
+#define VM_DISPATCH() goto dispatch
+#endif
+#define VM_NEXT() do { ++ip; VM_DISPATCH(); } while (0)
+#define VM_JUMP(to)                                                       \
+    do {                                                                  \
+        executed += static_cast<uint32_t>(ip - stretch) + 1;              \
+        if (executed >= budget) return executed;                          \
+        ip = stretch = code + (to);                                       \
+        VM_DISPATCH();                                                    \
+    } while (0)
+
+#if BEHAVIOUR_VM_THREADED
+    VM_DISPATCH();
+#else
+dispatch:
+    switch (ip->op) {
+#endif
+        VM_OP(Halt)
+            return executed + static_cast<uint32_t>(ip - stretch) + 1;
+        VM_OP(Const)
+            r[ip->a] = ip->imm;
+            VM_NEXT();
+        VM_OP(Move)
+            r[ip->a] = r[ip->b];
+            VM_NEXT();
+        VM_OP(Add)
+            r[ip->a] = r[ip->b] + r[ip->c];
+            VM_NEXT();
+        VM_OP(Sub)
+            r[ip->a] = r[ip->b] - r[ip->c];
+            VM_NEXT();
+        VM_OP(Mul)
+            r[ip->a] = r[ip->b] * r[ip->c];
+            VM_NEXT();
+        VM_OP(Div) {
+            const float d = r[ip->c];
+            r[ip->a] = std::fabs(d) < DIV_EPSILON ? 0.0f : r[ip->b] / d;
+            VM_NEXT();
+        }
+        VM_OP(Min)
+            r[ip->a] = std::min(r[ip->b], r[ip->c]);
+            VM_NEXT();
+        VM_OP(Max)
+            r[ip->a] = std::max(r[ip->b], r[ip->c]);
+            VM_NEXT();
+        VM_OP(Abs)
+            r[ip->a] = std::fabs(r[ip->b]);
+            VM_NEXT();
+        VM_OP(Neg)
+            r[ip->a] = -r[ip->b];
+            VM_NEXT();
+        VM_OP(Tanh) {
+            const float x = std::clamp(r[ip->b], -3.0f, 3.0f);
+            r[ip->a] = x * (27.0f + x * x) / (27.0f + 9.0f * x * x);
+            VM_NEXT();
+        }
+        VM_OP(Less)
+            r[ip->a] = r[ip->b] < r[ip->c] ? 1.0f : 0.0f;
+            VM_NEXT();
+        VM_OP(Select)
+            r[ip->a] = r[ip->a] > 0.0f ? r[ip->b] : r[ip->c];
+            VM_NEXT();
+        VM_OP(Input)
+            r[ip->a] = inputs[ip->b];
+            VM_NEXT();
+        VM_OP(Output)
+            outputs[ip->b] = clampOutput(r[ip->a]);
+            VM_NEXT();
+        VM_OP(Jump)
+            VM_JUMP(ip->target);
+        VM_OP(JumpIf)
+            if (r[ip->a] > 0.0f) VM_JUMP(ip->target);
+            VM_NEXT();
+#if !BEHAVIOUR_VM_THREADED
+        case BehaviourOp::Count:
+            break;
+    }
+    return executed;
+#endif
+
+#undef VM_OP
+#undef VM_DISPATCH
+#undef VM_NEXT
+#undef VM_JUMP
+}
+
+} // namespace BehaviourVM
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Register-based bytecode decoded from creature DNA.
+//
+// DNA is read in 4-byte codons, one instruction each: the first byte picks
+// the opcode, the rest registers, an immediate or a jump offset. Every byte
+// string decodes to a valid program: register, sensor and actuator indices
+// are reduced into range and jump targets clamped to the program, and a
+// Halt is appended. Programs that do not come from decode() must pass
+// verify(). run() can then skip all bounds checks.
+//
+// A run starts with zeroed registers, reads sensors with Input and drives
+// actuators with Output (clamped to [-1, 1], NaN written as 0). Backward
+// jumps make loops possible; the instruction budget ends them.
+
+enum class BehaviourOp : uint8_t {
+    Halt,
+    Const,    // r[a] = imm
+    Move,     // r[a] = r[b]
+    Add,      // r[a] = r[b] + r[c]
+    Sub,
+    Mul,
+    Div,      // 0 when |r[c]| is tiny
+    Min,
+    Max,
+    Abs,      // r[a] = |r[b]|
+    Neg,
+    Tanh,     // Rational approximation, exact at 0 and saturating at +-3
+    Less,     // r[a] = r[b] < r[c] ? 1 : 0
+    Select,   // r[a] = r[a] > 0 ? r[b] : r[c]
+    Input,    // r[a] = inputs[b]
+    Output,   // outputs[b] = clamp(r[a])
+    Jump,     // Go to target
+    JumpIf,   // Go to target if r[a] > 0
+    Count
+};
+
+struct BehaviourInstruction {
+    BehaviourOp op;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+    union {
+        float imm;         // Const
+        uint32_t target;   // Jump, JumpIf: instruction index
+    };
+};
+
+struct BehaviourProgram {
+    std::vector<BehaviourInstruction> code;  // Always ends with Halt
+};
+
+namespace BehaviourVM {
+
+constexpr uint32_t REGISTER_COUNT = 16;
+constexpr uint32_t INPUT_COUNT = 8;       // Sensors per creature
+constexpr uint32_t OUTPUT_COUNT = 4;      // Actuators per creature
+constexpr size_t MAX_PROGRAM_LENGTH = 256;
+constexpr size_t CODON_SIZE = 4;
+
+// Decode DNA (the first MAX_PROGRAM_LENGTH - 1 codons; a trailing partial
+// codon is ignored)
+BehaviourProgram decode(const uint8_t* dna, size_t size);
+
+// True if run() may execute `program` without going out of bounds
+bool verify(const BehaviourProgram& program);
+
+// Run once. Returns the instructions executed. The budget is checked on
+// every taken jump, so a run overshoots it by at most one straight stretch
+// of code (never more than MAX_PROGRAM_LENGTH instructions).
+uint32_t run(const BehaviourProgram& program, const float* inputs, float* outputs, uint32_t budget);
+
+} // namespace BehaviourVM
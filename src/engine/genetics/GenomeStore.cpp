@@ -0,0 +1,315 @@
+#include "GenomeStore.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Mutations are offset << 8 | byte, so offsets must fit in 24 bits
+constexpr size_t MAX_DELTA_LENGTH = size_t{1} << 24;
+
+// Roots read from a save are capped well beyond any real genome, so a
+// corrupt length cannot ask for gigabytes
+constexpr size_t MAX_ROOT_LENGTH = size_t{1} << 26;
+
+// A delta pays off while it stays well under the size of a full copy
+constexpr size_t DELTA_RATIO = 8;
+
+uint64_t hashBytes(const uint8_t* data, size_t size) {
+    uint64_t h = 14695981039346656037ull;  // FNV-1a
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ data[i]) * 1099511628211ull;
+    }
+    return h ^ size;
+}
+
+// Arenas smaller than this are not worth compacting
+constexpr size_t MIN_COMPACT_BYTES = 64 * 1024;
+
+uint32_t mutationAt(const uint8_t* data, size_t i) {
+    uint32_t m;
+    std::memcpy(&m, data + i * sizeof(uint32_t), sizeof(m));
+    return m;
+}
+
+} // namespace
+
+GenomeStore::GenomeId GenomeStore::allocate() {
+    ++m_liveCount;
+    if (!m_free.empty()) {
+        const GenomeId id = m_free.back();
+        m_free.pop_back();
+        return id;
+    }
+    m_entries.emplace_back();
+    return static_cast<GenomeId>(m_entries.size() - 1);
+}
+
+GenomeStore::GenomeId GenomeStore::addRoot(const uint8_t* data, size_t size, uint64_t hash) {
+    const GenomeId id = allocate();
+    Entry& e = m_entries[id];
+    e.parent = NO_GENOME;
+    e.length = static_cast<uint32_t>(size);
+    e.depth = 0;
+    e.refs = 1;
+    store(e, data, size);
+    m_roots.emplace(hash, id);
+    return id;
+}
+
+GenomeStore::GenomeId GenomeStore::intern(const uint8_t* data, size_t size) {
+    const uint64_t hash = hashBytes(data, size);
+    auto range = m_roots.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Entry& e = m_entries[it->second];
+        if (e.size == size && std::equal(bytes(e), bytes(e) + e.size, data)) {
+            addRef(it->second);
+            return it->second;
+        }
+    }
+    return addRoot(data, size, hash);
+}
+
+GenomeStore::GenomeId GenomeStore::derive(GenomeId parent, const uint8_t* data, size_t size) {
+    if (!isValid(parent) || size >= MAX_DELTA_LENGTH) {
+        return intern(data, size);
+    }
+
+    // Rebase halfway up the chain rather than grow it past its limit
+    const uint32_t parentDepth = m_entries[parent].depth;
+    const GenomeId base = parentDepth >= MAX_CHAIN_DEPTH ? ancestorAt(parent, parentDepth / 2) : parent;
+    materialize(base, m_base);
+
+    if (!diff(m_base, data, size, size / DELTA_RATIO, m_mutations)) {
+        return intern(data, size);
+    }
+    if (m_mutations.empty() && size == m_base.size()) {
+        addRef(base);  // Unmutated copy
+        return base;
+    }
+
+    const GenomeId id = allocate();
+    Entry& e = m_entries[id];
+    e.parent = base;
+    e.length = static_cast<uint32_t>(size);
+    e.depth = static_cast<uint16_t>(m_entries[base].depth + 1);
+    e.refs = 1;
+    store(e, reinterpret_cast<const uint8_t*>(m_mutations.data()), m_mutations.size() * sizeof(uint32_t));
+    addRef(base);
+    return id;
+}
+
+void GenomeStore::store(Entry& e, const uint8_t* data, size_t size) {
+    // A child differing only in length has no mutations, and insert must
+    // not be handed the null pointer of an empty vector
+    e.offset = static_cast<uint32_t>(m_data.size());
+    e.size = static_cast<uint32_t>(size);
+    if (size > 0) {
+        m_data.insert(m_data.end(), data, data + size);
+    }
+}
+
+void GenomeStore::addRef(GenomeId id) {
+    if (id != NO_GENOME) {
+        ++m_entries[id].refs;
+    }
+}
+
+void GenomeStore::release(GenomeId id) {
+    // Freeing a genome drops its reference on the parent
+    while (id != NO_GENOME) {
+        Entry& e = m_entries[id];
+        if (--e.refs > 0) break;
+
+        if (e.parent == NO_GENOME) {
+            forgetRoot(id);
+        }
+        const GenomeId parent = e.parent;
+        const uint16_t generation = e.generation;
+        m_garbage += e.size;
+        e = Entry();
+        e.generation = static_cast<uint16_t>(generation + 1);
+        m_free.push_back(id);
+        --m_liveCount;
+        id = parent;
+    }
+    if (m_garbage >= MIN_COMPACT_BYTES && m_garbage * 2 >= m_data.size()) {
+        compact();
+    }
+}
+
+void GenomeStore::compact() {
+    std::vector<uint8_t> data;
+    data.reserve(m_data.size() - m_garbage);
+    for (Entry& e : m_entries) {
+        if (e.refs == 0 || e.size == 0) continue;
+        const uint32_t offset = static_cast<uint32_t>(data.size());
+        data.insert(data.end(), bytes(e), bytes(e) + e.size);
+        e.offset = offset;
+    }
+    m_data.swap(data);
+    m_garbage = 0;
+}
+
+void GenomeStore::forgetRoot(GenomeId id) {
+    const Entry& e = m_entries[id];
+    auto range = m_roots.equal_range(hashBytes(bytes(e), e.size));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == id) {
+            m_roots.erase(it);
+            return;
+        }
+    }
+}
+
+GenomeStore::GenomeId GenomeStore::ancestorAt(GenomeId id, uint32_t depth) const {
+    while (m_entries[id].depth > depth) {
+        id = m_entries[id].parent;
+    }
+    return id;
+}
+
+void GenomeStore::materialize(GenomeId id, std::vector<uint8_t>& out) const {
+    // Collect the chain, then apply deltas from the root down
+    std::vector<GenomeId>& chain = m_chain;
+    chain.clear();
+    GenomeId at = id;
+    for (; m_entries[at].parent != NO_GENOME; at = m_entries[at].parent) {
+        chain.push_back(at);
+    }
+
+    const Entry& root = m_entries[at];
+    out.assign(bytes(root), bytes(root) + root.size);
+    for (size_t i = chain.size(); i-- > 0;) {
+        const Entry& e = m_entries[chain[i]];
+        out.resize(e.length, 0);
+        for (size_t m = 0; m < e.size / sizeof(uint32_t); ++m) {
+            const uint32_t mutation = mutationAt(bytes(e), m);
+            out[mutation >> 8] = static_cast<uint8_t>(mutation & 0xFF);
+        }
+    }
+}
+
+bool GenomeStore::diff(const std::vector<uint8_t>& base, const uint8_t* data, size_t size,
+                       size_t limit, std::vector<uint32_t>& out) {
+    // Bytes past the end of `base` read as 0, as they do after a resize
+    out.clear();
+    for (size_t i = 0; i < size; ++i) {
+        const uint8_t was = i < base.size() ? base[i] : 0;
+        if (data[i] != was) {
+            if (out.size() == limit) return false;
+            out.push_back(static_cast<uint32_t>(i << 8) | data[i]);
+        }
+    }
+    return true;
+}
+
+size_t GenomeStore::getMemoryUsage() const {
+    return m_entries.capacity() * sizeof(Entry) + m_data.capacity() + m_free.capacity() * sizeof(GenomeId) +
+           m_roots.size() * (sizeof(uint64_t) + sizeof(GenomeId) + 2 * sizeof(void*));
+}
+
+void GenomeStore::clear() {
+    m_entries.clear();
+    m_data.clear();
+    m_garbage = 0;
+    m_free.clear();
+    m_roots.clear();
+    m_liveCount = 0;
+}
+
+void GenomeStore::Serialize(EvolutionSim::BinaryWriter& writer) const {
+    // Parents before children, so a reader can check every link
+    std::vector<GenomeId> live;
+    live.reserve(m_liveCount);
+    for (GenomeId id = 0; id < m_entries.size(); ++id) {
+        if (m_entries[id].refs > 0) live.push_back(id);
+    }
+    std::stable_sort(live.begin(), live.end(), [this](GenomeId a, GenomeId b) {
+        return m_entries[a].depth < m_entries[b].depth;
+    });
+
+    writer.WriteUint32(static_cast<uint32_t>(m_entries.size()));
+    writer.WriteUint32(static_cast<uint32_t>(live.size()));
+    for (GenomeId id : live) {
+        const Entry& e = m_entries[id];
+        writer.WriteUint32(id);
+        writer.WriteUint32(e.parent);
+        writer.WriteUint32(e.length);
+        writer.WriteUint32(e.refs);
+        if (e.parent == NO_GENOME) {
+            writer.WriteBytes(bytes(e), e.size);
+        } else {
+            const size_t count = e.size / sizeof(uint32_t);
+            writer.WriteUint32(static_cast<uint32_t>(count));
+            for (size_t m = 0; m < count; ++m) {
+                writer.WriteUint32(mutationAt(bytes(e), m));
+            }
+        }
+    }
+}
+
+void GenomeStore::Deserialize(EvolutionSim::BinaryReader& reader) {
+    clear();
+
+    // Each genome takes at least 16 bytes; check counts before allocating
+    const uint32_t slots = reader.ReadUint32();
+    const uint32_t live = reader.ReadUint32();
+    const size_t remaining = reader.GetSize() - reader.GetPosition();
+    if (live > slots || static_cast<size_t>(live) * 16 > remaining || slots - live > remaining) {
+        throw std::out_of_range("Genome count exceeds buffer size");
+    }
+    m_entries.resize(slots);
+
+    for (uint32_t i = 0; i < live; ++i) {
+        const GenomeId id = reader.ReadUint32();
+        const GenomeId parent = reader.ReadUint32();
+        const uint32_t length = reader.ReadUint32();
+        const uint32_t refs = reader.ReadUint32();
+        if (id >= slots || m_entries[id].refs != 0 || refs == 0) {
+            throw std::runtime_error("Corrupt genome table");
+        }
+
+        Entry& e = m_entries[id];
+        e.length = length;
+        e.refs = refs;
+        if (parent == NO_GENOME) {
+            if (length > MAX_ROOT_LENGTH || length > reader.GetSize() - reader.GetPosition()) {
+                throw std::out_of_range("Genome exceeds buffer size");
+            }
+            e.offset = static_cast<uint32_t>(m_data.size());
+            e.size = length;
+            m_data.resize(m_data.size() + length);
+            reader.ReadBytes(m_data.data() + e.offset, length);
+            m_roots.emplace(hashBytes(bytes(e), length), id);
+        } else {
+            // derive() never makes deltas this long; materialize() would
+            // resize to the length unchecked
+            if (!isValid(parent) || parent == id || m_entries[parent].depth >= MAX_CHAIN_DEPTH ||
+                length >= MAX_DELTA_LENGTH) {
+                throw std::runtime_error("Corrupt genome table");
+            }
+            const uint32_t count = reader.ReadUint32();
+            if (static_cast<size_t>(count) * sizeof(uint32_t) > reader.GetSize() - reader.GetPosition()) {
+                throw std::out_of_range("Genome exceeds buffer size");
+            }
+            e.parent = parent;
+            e.depth = static_cast<uint16_t>(m_entries[parent].depth + 1);
+            e.offset = static_cast<uint32_t>(m_data.size());
+            e.size = count * static_cast<uint32_t>(sizeof(uint32_t));
+            for (uint32_t m = 0; m < count; ++m) {
+                const uint32_t mutation = reader.ReadUint32();
+                if ((mutation >> 8) >= length) {
+                    throw std::runtime_error("Corrupt genome table");
+                }
+                const uint8_t* word = reinterpret_cast<const uint8_t*>(&mutation);
+                m_data.insert(m_data.end(), word, word + sizeof(mutation));
+            }
+        }
+    }
+
+    m_liveCount = live;
+    for (GenomeId id = slots; id-- > 0;) {
+        if (m_entries[id].refs == 0) m_free.push_back(id);
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "serialization/Serialization.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Interned genomes stored as deltas against an ancestor.
+//
+// Offspring DNA differs from its parent's in a handful of bytes, so a genome
+// derived from a parent is kept as the parent's id plus a list of point
+// mutations (offset, new byte). Genomes without a usable ancestor are roots
+// stored in full; identical roots are shared. Bytes are materialized on
+// demand by walking the chain up to its root.
+//
+// Chains are rebased as they grow: once a new genome would sit deeper than
+// MAX_CHAIN_DEPTH it is diffed against its ancestor halfway up the chain
+// instead, so materializing never walks more than MAX_CHAIN_DEPTH links.
+// Genomes whose diff is too large to pay off are stored as new roots.
+//
+// Genomes are reference counted; a child holds a reference on its parent,
+// so ancestors of living genomes stay materializable. Ids are stable for the
+// life of a genome and survive Serialize / Deserialize. Not thread-safe.
+class GenomeStore : public EvolutionSim::ISerializable {
+public:
+    using GenomeId = uint32_t;
+    static constexpr GenomeId NO_GENOME = 0xFFFFFFFFu;
+    static constexpr uint32_t MAX_CHAIN_DEPTH = 16;
+
+    // Store `data` as a root, or share an identical existing root. The
+    // caller owns one reference to the result.
+    GenomeId intern(const uint8_t* data, size_t size);
+
+    // Store `data` relative to `parent`. The caller owns one reference.
+    GenomeId derive(GenomeId parent, const uint8_t* data, size_t size);
+
+    void addRef(GenomeId id);
+    void release(GenomeId id);
+
+    bool isValid(GenomeId id) const {
+        return id < m_entries.size() && m_entries[id].refs > 0;
+    }
+
+    // Write the genome's bytes to `out` (resized to its length)
+    void materialize(GenomeId id, std::vector<uint8_t>& out) const;
+
+    uint32_t getLength(GenomeId id) const { return m_entries[id].length; }
+    uint32_t getDepth(GenomeId id) const { return m_entries[id].depth; }
+
+    // Changes each time the id is reused for a new genome, so caches keyed by
+    // id can tell a stale entry (wraps after 65536 reuses of one slot). Not
+    // saved, and reset by clear() and Deserialize(), so clear such caches
+    // along with the store.
+    uint16_t getGeneration(GenomeId id) const { return m_entries[id].generation; }
+
+    size_t getGenomeCount() const { return m_liveCount; }
+    size_t getMemoryUsage() const;
+
+    void clear();
+
+    // ISerializable: live genomes keep their ids and reference counts
+    void Serialize(EvolutionSim::BinaryWriter& writer) const override;
+    void Deserialize(EvolutionSim::BinaryReader& reader) override;
+
+private:
+    // Each entry's bytes live in the shared arena m_data at [offset, offset
+    // + size). Roots keep the whole genome there; deltas keep their
+    // mutations, 4 bytes each (offset << 8 | byte, ascending offsets).
+    struct Entry {
+        GenomeId parent = NO_GENOME;        // NO_GENOME for roots
+        uint32_t length = 0;
+        uint16_t depth = 0;                 // Links to the root
+        uint16_t generation = 0;            // Bumped when the slot is freed
+        uint32_t refs = 0;                  // 0 = free slot
+        uint32_t offset = 0;                // Into m_data
+        uint32_t size = 0;                  // Bytes in m_data
+    };
+
+    GenomeId allocate();
+    GenomeId addRoot(const uint8_t* data, size_t size, uint64_t hash);
+    GenomeId ancestorAt(GenomeId id, uint32_t depth) const;
+    void forgetRoot(GenomeId id);
+
+    const uint8_t* bytes(const Entry& e) const { return m_data.data() + e.offset; }
+    void store(Entry& e, const uint8_t* data, size_t size);
+
+    // Drop the bytes of freed entries once they make up half the arena
+    void compact();
+
+    // Mutations turning `base` into `data`; false if there would be more
+    // than `limit` of them
+    static bool diff(const std::vector<uint8_t>& base, const uint8_t* data, size_t size,
+                     size_t limit, std::vector<uint32_t>& out);
+
+    std::vector<Entry> m_entries;
+    std::vector<uint8_t> m_data;            // Arena for every entry's bytes
+    size_t m_garbage = 0;                   // Bytes of m_data held by freed entries
+    std::vector<GenomeId> m_free;
+    std::unordered_multimap<uint64_t, GenomeId> m_roots;  // Content hash -> root
+    size_t m_liveCount = 0;
+
+    // Scratch for derive() and materialize()
+    std::vector<uint8_t> m_base;
+    std::vector<uint32_t> m_mutations;
+    mutable std::vector<GenomeId> m_chain;
+};
@@ -0,0 +1,291 @@
+#include "IslandModel.hpp"
+#include "core/JobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, n)
+uint32_t below(uint64_t& state, uint32_t n) {
+    return static_cast<uint32_t>(((splitmix64(state) >> 32) * n) >> 32);
+}
+
+// Uniform in (0, 1]
+double unitOpen(uint64_t& state) {
+    return (static_cast<double>(splitmix64(state) >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+}
+
+} // namespace
+
+struct IslandModel::Island {
+    explicit Island(size_t inboxCapacity) : inbox(inboxCapacity) {}
+
+    GenomeStore store;
+    std::vector<GenomeStore::GenomeId> members;
+    std::vector<float> fitness;
+    uint64_t rng = 0;
+    SpscQueue<Migrant> inbox;
+    uint64_t evaluations = 0;
+    uint64_t immigrants = 0;
+
+    // Scratch
+    std::vector<uint8_t> dna;
+    std::vector<uint32_t> ranking;
+    std::vector<Migrant> arrivals;
+};
+
+IslandModel::IslandModel(FitnessFn fitness)
+    : IslandModel(std::move(fitness), Settings()) {}
+
+IslandModel::IslandModel(FitnessFn fitness, const Settings& settings)
+    : m_fitness(std::move(fitness))
+    , m_settings(settings) {
+    m_settings.islands = std::max<uint32_t>(1, m_settings.islands);
+    m_settings.populationSize = std::max<uint32_t>(2, m_settings.populationSize);
+    m_settings.genomeLength = std::max<uint32_t>(1, m_settings.genomeLength);
+    m_settings.tournamentSize = std::max<uint32_t>(1, m_settings.tournamentSize);
+    m_settings.migrants = std::min(m_settings.migrants, m_settings.populationSize / 2);
+
+    for (uint32_t i = 0; i < m_settings.islands; ++i) {
+        m_islands.push_back(std::make_unique<Island>(std::max<uint32_t>(1, m_settings.migrants)));
+    }
+    m_destinations.assign(m_settings.islands, 0);
+    m_sources.assign(m_settings.islands, 0);
+    reset();
+}
+
+IslandModel::~IslandModel() = default;
+
+void IslandModel::reset() {
+    m_tick = 0;
+    m_exchanges = 0;
+    JobSystem::get().parallelFor(m_islands.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t index = begin; index < end; ++index) {
+            Island& island = *m_islands[index];
+            Migrant stale;
+            while (island.inbox.tryPop(stale)) {}
+
+            island.store.clear();
+            island.rng = m_settings.seed ^ (0xA0761D6478BD642Full * (index + 1));
+            island.evaluations = 0;
+            island.immigrants = 0;
+            island.members.resize(m_settings.populationSize);
+            island.fitness.resize(m_settings.populationSize);
+            island.dna.resize(m_settings.genomeLength);
+            for (uint32_t m = 0; m < m_settings.populationSize; ++m) {
+                for (uint8_t& byte : island.dna) {
+                    byte = static_cast<uint8_t>(splitmix64(island.rng));
+                }
+                island.members[m] = island.store.intern(island.dna.data(), island.dna.size());
+                island.fitness[m] = m_fitness(static_cast<uint32_t>(index), island.dna.data(), island.dna.size());
+                ++island.evaluations;
+            }
+        }
+    }, 1);
+}
+
+void IslandModel::planExchange() {
+    const uint32_t count = getIslandCount();
+    if (m_settings.topology == Topology::Ring) {
+        for (uint32_t i = 0; i < count; ++i) {
+            m_destinations[i] = (i + 1) % count;
+        }
+    } else {
+        // Sattolo's shuffle: a uniformly random single cycle, so no island
+        // sends to itself and each receives from exactly one other
+        uint64_t rng = m_settings.seed ^ (0xE7037ED1A0B428DBull * (m_exchanges + 1));
+        std::iota(m_destinations.begin(), m_destinations.end(), 0u);
+        for (uint32_t i = count - 1; i > 0; --i) {
+            std::swap(m_destinations[i], m_destinations[below(rng, i)]);
+        }
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        m_sources[m_destinations[i]] = i;
+    }
+}
+
+void IslandModel::evolve(uint32_t index, uint32_t ticks) {
+    Island& island = *m_islands[index];
+    const uint32_t population = static_cast<uint32_t>(island.members.size());
+    const double rate = std::clamp<double>(m_settings.mutationRate, 0.0, 1.0);
+    const double logKeep = rate < 1.0 ? std::log1p(-rate) : -1e300;
+
+    const auto tournament = [&](bool best) {
+        uint32_t pick = below(island.rng, population);
+        for (uint32_t k = 1; k < m_settings.tournamentSize; ++k) {
+            const uint32_t other = below(island.rng, population);
+            if (best ? island.fitness[other] > island.fitness[pick]
+                     : island.fitness[other] < island.fitness[pick]) {
+                pick = other;
+            }
+        }
+        return pick;
+    };
+
+    for (uint32_t t = 0; t < ticks; ++t) {
+        for (uint32_t o = 0; o < m_settings.offspringPerTick; ++o) {
+            const uint32_t parent = tournament(true);
+            island.store.materialize(island.members[parent], island.dna);
+
+            // Jump from mutation to mutation (geometric gaps) instead of
+            // drawing for every byte
+            if (rate > 0.0) {
+                double position = std::floor(std::log(unitOpen(island.rng)) / logKeep);
+                while (position < static_cast<double>(island.dna.size())) {
+                    island.dna[static_cast<size_t>(position)] ^= static_cast<uint8_t>(1 + below(island.rng, 255));
+                    position += 1.0 + std::floor(std::log(unitOpen(island.rng)) / logKeep);
+                }
+            }
+
+            const float score = m_fitness(index, island.dna.data(), island.dna.size());
+            ++island.evaluations;
+
+            // Derive before releasing: the loser may be the parent
+            const uint32_t loser = tournament(false);
+            const GenomeStore::GenomeId child =
+                island.store.derive(island.members[parent], island.dna.data(), island.dna.size());
+            island.store.release(island.members[loser]);
+            island.members[loser] = child;
+            island.fitness[loser] = score;
+        }
+    }
+}
+
+void IslandModel::emigrate(uint32_t index) {
+    Island& island = *m_islands[index];
+    Island& destination = *m_islands[m_destinations[index]];
+    const uint32_t migrants = m_settings.migrants;
+
+    island.ranking.resize(island.members.size());
+    std::iota(island.ranking.begin(), island.ranking.end(), 0u);
+    std::partial_sort(island.ranking.begin(), island.ranking.begin() + migrants, island.ranking.end(),
+                      [&](uint32_t a, uint32_t b) {
+                          return island.fitness[a] > island.fitness[b] ||
+                                 (island.fitness[a] == island.fitness[b] && a < b);
+                      });
+    for (uint32_t k = 0; k < migrants; ++k) {
+        Migrant migrant;
+        island.store.materialize(island.members[island.ranking[k]], migrant.dna);
+        destination.inbox.tryPush(std::move(migrant));
+    }
+}
+
+void IslandModel::immigrate(uint32_t index) {
+    Island& island = *m_islands[index];
+    island.arrivals.clear();
+    Migrant migrant;
+    while (island.inbox.tryPop(migrant)) {
+        island.arrivals.push_back(std::move(migrant));
+    }
+    if (island.arrivals.empty()) return;
+
+    // Arrivals replace the worst members. They are scored again here: an
+    // island may stand for a different world, so the sender's score says
+    // nothing about how fit a migrant is on this one.
+    const size_t count = std::min(island.arrivals.size(), island.members.size());
+    island.ranking.resize(island.members.size());
+    std::iota(island.ranking.begin(), island.ranking.end(), 0u);
+    std::partial_sort(island.ranking.begin(), island.ranking.begin() + count, island.ranking.end(),
+                      [&](uint32_t a, uint32_t b) {
+                          return island.fitness[a] < island.fitness[b] ||
+                                 (island.fitness[a] == island.fitness[b] && a < b);
+                      });
+    for (size_t k = 0; k < count; ++k) {
+        const Migrant& arrival = island.arrivals[k];
+        const uint32_t slot = island.ranking[k];
+        const GenomeStore::GenomeId id = island.store.intern(arrival.dna.data(), arrival.dna.size());
+        island.store.release(island.members[slot]);
+        island.members[slot] = id;
+        island.fitness[slot] = m_fitness(index, arrival.dna.data(), arrival.dna.size());
+        ++island.evaluations;
+    }
+    island.immigrants += count;
+}
+
+void IslandModel::run(uint32_t ticks) {
+    auto& jobs = JobSystem::get();
+    const uint32_t interval = m_settings.migrationInterval;
+    const bool migrate = interval > 0 && m_islands.size() > 1 && m_settings.migrants > 0;
+
+    while (ticks > 0) {
+        uint32_t span = ticks;
+        bool exchange = false;
+        if (migrate) {
+            const uint64_t untilExchange = interval - m_tick % interval;
+            if (untilExchange <= span) {
+                span = static_cast<uint32_t>(untilExchange);
+                exchange = true;
+                planExchange();
+            }
+        }
+
+        // One island per job; islands on the same worker run in turn
+        jobs.parallelFor(m_islands.size(), [&](size_t begin, size_t end, unsigned) {
+            for (size_t index = begin; index < end; ++index) {
+                evolve(static_cast<uint32_t>(index), span);
+                if (exchange) emigrate(static_cast<uint32_t>(index));
+            }
+        }, 1);
+        m_tick += span;
+        ticks -= span;
+
+        if (exchange) {
+            jobs.parallelFor(m_islands.size(), [&](size_t begin, size_t end, unsigned) {
+                for (size_t index = begin; index < end; ++index) {
+                    immigrate(static_cast<uint32_t>(index));
+                }
+            }, 1);
+            ++m_exchanges;
+        }
+    }
+}
+
+const GenomeStore& IslandModel::getStore(uint32_t island) const {
+    return m_islands[island]->store;
+}
+
+const std::vector<GenomeStore::GenomeId>& IslandModel::getMembers(uint32_t island) const {
+    return m_islands[island]->members;
+}
+
+const std::vector<float>& IslandModel::getFitness(uint32_t island) const {
+    return m_islands[island]->fitness;
+}
+
+float IslandModel::getBestFitness(uint32_t island) const {
+    const std::vector<float>& fitness = m_islands[island]->fitness;
+    return *std::max_element(fitness.begin(), fitness.end());
+}
+
+float IslandModel::getMeanFitness(uint32_t island) const {
+    const std::vector<float>& fitness = m_islands[island]->fitness;
+    double total = 0.0;
+    for (float f : fitness) {
+        total += f;
+    }
+    return static_cast<float>(total / fitness.size());
+}
+
+uint64_t IslandModel::getEvaluationCount() const {
+    uint64_t total = 0;
+    for (const auto& island : m_islands) {
+        total += island->evaluations;
+    }
+    return total;
+}
+
+uint64_t IslandModel::getMigrantCount() const {
+    uint64_t total = 0;
+    for (const auto& island : m_islands) {
+        total += island->immigrants;
+    }
+    return total;
+}
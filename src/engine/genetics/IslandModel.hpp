@@ -0,0 +1,98 @@
+#pragma once
+
+#include "GenomeStore.hpp"
+#include "core/SpscQueue.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Island-model evolution: K sub-populations evolving side by side on the
+// job system's workers, exchanging their best genomes every few ticks.
+//
+// Each island owns its genomes (a GenomeStore of its own, so islands never
+// share mutable state) and runs a steady-state loop: every tick it breeds
+// offspringPerTick children from tournament-selected parents by point
+// mutation, scores them with the fitness callback and lets each replace the
+// loser of a reverse tournament. The callback gets the island index, so an
+// island can stand for its own world or region.
+//
+// Every migrationInterval ticks each island sends copies of its best
+// `migrants` genomes to one other island, which scores them with its own
+// fitness and puts them in place of its worst. Migrants travel through a
+// lock-free single-producer queue per island: the exchange pattern (Ring:
+// island i sends to i + 1; Random: a single random cycle drawn from the seed
+// each time) gives every island exactly one sender. Islands send at the end of their evolution pass and
+// take delivery in a short second pass once all have sent, and every island
+// draws from its own seeded generator, so runs are identical whatever the
+// worker count.
+class IslandModel {
+public:
+    enum class Topology : uint8_t {
+        Ring,
+        Random
+    };
+
+    struct Settings {
+        uint32_t islands = 4;
+        uint32_t populationSize = 256;    // Per island
+        uint32_t genomeLength = 256;      // Bytes of a random initial genome
+        uint32_t offspringPerTick = 8;    // Per island
+        uint32_t tournamentSize = 3;
+        float mutationRate = 0.01f;       // Chance each byte of a child changes
+        uint32_t migrationInterval = 50;  // Ticks between exchanges; 0 = isolated islands
+        uint32_t migrants = 4;            // Genomes each island sends per exchange
+        Topology topology = Topology::Ring;
+        uint64_t seed = 1;
+    };
+
+    // Called concurrently for different islands; must be thread-safe
+    using FitnessFn = std::function<float(uint32_t island, const uint8_t* dna, size_t size)>;
+
+    explicit IslandModel(FitnessFn fitness);
+    IslandModel(FitnessFn fitness, const Settings& settings);
+    ~IslandModel();
+
+    // Fill every island with random genomes and restart at tick 0
+    void reset();
+
+    // Evolve every island by `ticks` ticks, exchanging migrants on the way
+    void run(uint32_t ticks);
+
+    uint64_t getTick() const { return m_tick; }
+    uint32_t getIslandCount() const { return static_cast<uint32_t>(m_islands.size()); }
+    const Settings& getSettings() const { return m_settings; }
+
+    const GenomeStore& getStore(uint32_t island) const;
+    const std::vector<GenomeStore::GenomeId>& getMembers(uint32_t island) const;
+    const std::vector<float>& getFitness(uint32_t island) const;
+    float getBestFitness(uint32_t island) const;
+    float getMeanFitness(uint32_t island) const;
+
+    // Island that sent migrants to `island` at the last exchange
+    uint32_t getSource(uint32_t island) const { return m_sources[island]; }
+
+    uint64_t getEvaluationCount() const;
+    uint64_t getMigrantCount() const;
+
+private:
+    struct Migrant {
+        std::vector<uint8_t> dna;
+    };
+
+    struct Island;
+
+    void planExchange();
+    void evolve(uint32_t index, uint32_t ticks);
+    void emigrate(uint32_t index);
+    void immigrate(uint32_t index);
+
+    FitnessFn m_fitness;
+    Settings m_settings;
+    std::vector<std::unique_ptr<Island>> m_islands;
+    std::vector<uint32_t> m_destinations;  // Per island, for the next exchange
+    std::vector<uint32_t> m_sources;
+    uint64_t m_tick = 0;
+    uint64_t m_exchanges = 0;
+};
@@ -0,0 +1,44 @@
+#include "ExportArena.hpp"
+#include "GridAllocator.hpp"
+#include "../Logging.hpp"
+#include <atomic>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/heap.h>
+#endif
+
+ExportArena::ExportArena(size_t capacityBytes)
+    : m_block(static_cast<unsigned char*>(GridMemory::allocate(capacityBytes))),
+      m_capacity(capacityBytes) {}
+
+ExportArena::~ExportArena() {
+    GridMemory::deallocate(m_block, m_capacity);
+}
+
+void* ExportArena::allocateBytes(size_t bytes, const std::string& name) {
+    const size_t offset = (m_used + GridMemory::CACHE_LINE_SIZE - 1) & ~(GridMemory::CACHE_LINE_SIZE - 1);
+    if (offset > m_capacity || bytes > m_capacity - offset) {
+        LOG_WARNING("Export arena full, cannot place '" + name + "' (" + std::to_string(bytes) +
+                    " bytes, " + std::to_string(m_capacity - m_used) + " free)");
+        return nullptr;
+    }
+    m_used = offset + bytes;
+    return m_block + offset;
+}
+
+uint32_t ExportArena::growthEpoch() {
+#ifdef __EMSCRIPTEN__
+    // The heap only grows, so a size change means the buffer was replaced
+    static std::atomic<size_t> s_heapSize{0};
+    static std::atomic<uint32_t> s_epoch{0};
+
+    const size_t size = emscripten_get_heap_size();
+    const size_t last = s_heapSize.exchange(size, std::memory_order_relaxed);
+    if (last != 0 && size != last) {
+        return s_epoch.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    return s_epoch.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fixed block of memory for buffers that JS reads through typed-array views.
+//
+// With ALLOW_MEMORY_GROWTH every heap growth replaces the WASM ArrayBuffer and
+// detaches all views over it, wherever they point. What an arena guarantees is
+// that its buffers never move: they are carved once from a block reserved up
+// front, so a view only has to be recreated after the heap actually grows.
+// JS checks growthEpoch() once per frame and rewraps only when it changed,
+// instead of wrapping every buffer every frame.
+class ExportArena {
+public:
+    explicit ExportArena(size_t capacityBytes);
+    ~ExportArena();
+
+    ExportArena(const ExportArena&) = delete;
+    ExportArena& operator=(const ExportArena&) = delete;
+
+    // Carve `count` elements, cache-line aligned. Returns nullptr (and logs)
+    // when the arena is full; buffers stay valid until reset().
+    template <typename T>
+    T* allocate(size_t count, const std::string& name) {
+        return static_cast<T*>(allocateBytes(count * sizeof(T), name));
+    }
+
+    // Forget all buffers; the block itself is kept
+    void reset() { m_used = 0; }
+
+    size_t capacity() const { return m_capacity; }
+    size_t used() const { return m_used; }
+
+    // Counter bumped each time the WASM heap is seen to have grown. Always 0
+    // on native builds, where memory never moves under a view.
+    static uint32_t growthEpoch();
+
+private:
+    void* allocateBytes(size_t bytes, const std::string& name);
+
+    unsigned char* m_block;
+    size_t m_capacity;
+    size_t m_used = 0;
+};
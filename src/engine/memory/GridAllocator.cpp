@@ -0,0 +1,102 @@
+#include "GridAllocator.hpp"
+#include "core/FlightRecorder.hpp"
+#include <atomic>
+#include <cstdlib>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define GRID_MEMORY_LINUX 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace GridMemory {
+
+namespace {
+
+#ifdef GRID_MEMORY_LINUX
+std::atomic<bool> s_hugePages{true};
+#else
+std::atomic<bool> s_hugePages{false};
+#endif
+
+// Allocations at least this big are noted in the flight recorder
+constexpr size_t RECORDED_ALLOCATION_SIZE = size_t{1} << 20;
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+void* allocate(size_t bytes) {
+    if (bytes == 0) bytes = 1;
+
+#ifdef GRID_MEMORY_LINUX
+    const size_t alignment = bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : CACHE_LINE_SIZE;
+#else
+    // No huge pages to line up with (WASM linear memory never gets them),
+    // and 2MB alignment would waste up to 2MB of a capped heap per plane
+    const size_t alignment = CACHE_LINE_SIZE;
+#endif
+    // aligned_alloc requires the size to be a multiple of the alignment
+    const size_t size = roundUp(bytes, alignment);
+    void* ptr = std::aligned_alloc(alignment, size);
+    if (size >= RECORDED_ALLOCATION_SIZE || !ptr) {
+        FlightRecorder::record(FlightRecorder::EventType::Allocation, ptr ? "grid" : "grid (failed)", size);
+    }
+    if (!ptr) throw std::bad_alloc();
+
+#ifdef GRID_MEMORY_LINUX
+    if (alignment == HUGE_PAGE_SIZE && s_hugePages.load(std::memory_order_relaxed)) {
+        // Advisory only; failure (THP disabled) just means 4KB pages
+        madvise(ptr, size, MADV_HUGEPAGE);
+    }
+#endif
+    return ptr;
+}
+
+void deallocate(void* ptr, size_t) {
+    std::free(ptr);
+}
+
+void setHugePagesEnabled(bool enabled) {
+#ifdef GRID_MEMORY_LINUX
+    s_hugePages.store(enabled, std::memory_order_relaxed);
+#else
+    (void)enabled;
+#endif
+}
+
+bool hugePagesEnabled() {
+    return s_hugePages.load(std::memory_order_relaxed);
+}
+
+int currentNode() {
+#if defined(GRID_MEMORY_LINUX) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return -1;
+}
+
+bool pageNodes(const void* const* pages, size_t count, int* nodes) {
+#if defined(GRID_MEMORY_LINUX) && defined(SYS_move_pages)
+    // move_pages with a null node list only queries placement
+    const long result = syscall(SYS_move_pages, 0, count, pages, nullptr, nodes, 0);
+    if (result != 0) return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (nodes[i] < 0) nodes[i] = -1;  // -EFAULT / -ENOENT: not mapped yet
+    }
+    return true;
+#else
+    (void)pages;
+    for (size_t i = 0; i < count; ++i) nodes[i] = -1;
+    return false;
+#endif
+}
+
+} // namespace GridMemory
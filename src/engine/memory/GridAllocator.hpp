@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Allocator for large simulation planes.
+//
+// On native Linux, blocks of at least HUGE_PAGE_SIZE are 2MB-aligned and
+// advised for transparent huge pages, which cuts TLB misses on full-grid
+// sweeps. Elsewhere (including WASM) blocks are only cache-line aligned.
+// Elements are default-initialized, so resizing a vector does not write its
+// pages: the first write decides which NUMA node a page lives on, and the
+// owner (see TemperatureSystem::initialize) makes that write from the worker
+// that will keep updating it. Workers are pinned on native Linux (see
+// core/JobSystem.hpp), but the calling thread that runs band 0 is not, so
+// placement is best effort; checkNumaPlacement() reports how it went.
+namespace GridMemory {
+
+constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+void* allocate(size_t bytes);
+void deallocate(void* ptr, size_t bytes);
+
+// Toggle the huge page advice for future allocations (on by default where
+// supported). Has no effect on WASM or non-Linux builds.
+void setHugePagesEnabled(bool enabled);
+bool hugePagesEnabled();
+
+// NUMA node of the calling thread's CPU, or -1 if unknown
+int currentNode();
+
+// NUMA node of each page in `pages`, -1 where unknown. Returns false if the
+// platform cannot report placement.
+bool pageNodes(const void* const* pages, size_t count, int* nodes);
+
+// Placement check: how many sampled pages of each worker's band live on the
+// node that worker runs on
+struct NumaReport {
+    bool supported = false;
+    size_t pagesSampled = 0;
+    size_t pagesLocal = 0;
+    std::vector<int> workerNodes;  // Node each worker ran on, -1 if unknown
+};
+
+} // namespace GridMemory
+
+template <typename T>
+class GridAllocator {
+public:
+    using value_type = T;
+
+    GridAllocator() = default;
+    template <typename U>
+    GridAllocator(const GridAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(GridMemory::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        GridMemory::deallocate(ptr, n * sizeof(T));
+    }
+
+    // Default-initialize on resize() so untouched pages stay untouched
+    template <typename U>
+    void construct(U* ptr) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        ::new (static_cast<void*>(ptr)) U(static_cast<Args&&>(args)...);
+    }
+
+    template <typename U>
+    bool operator==(const GridAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const GridAllocator<U>&) const { return false; }
+};
+
+// Storage for one simulation field plane
+using FieldPlane = std::vector<double, GridAllocator<double>>;
@@ -0,0 +1,286 @@
+#include "BlockCompression.hpp"
+#include "core/JobSystem.hpp"
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace EvolutionSim {
+
+namespace BlockCompression {
+
+namespace {
+
+// LZ77 parameters (LZ4-style sequences: token, literals, offset, match)
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;      // Trailing bytes always emitted as literals
+constexpr size_t MATCH_SEARCH_END = 12;  // No match may start in the last bytes
+constexpr size_t MAX_OFFSET = 65535;
+constexpr unsigned HASH_BITS = 14;
+
+// Smallest footprint of a non-empty block: its directory entry plus at
+// least one byte of data (a raw byte or a sequence token)
+constexpr size_t MIN_BLOCK_BYTES = sizeof(uint32_t) + 1;
+
+// Most bytes one stored byte can decode to: a match sequence spends one
+// byte per 255 bytes of match length, and raw blocks store every byte
+constexpr uint64_t MAX_EXPANSION = 255;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t hash32(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void writeLength(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+void emitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount,
+                  size_t offset, size_t matchLength) {
+    const size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+    out.push_back(static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) |
+                                       std::min<size_t>(matchCode, 15)));
+    if (literalCount >= 15) writeLength(out, literalCount - 15);
+    out.insert(out.end(), literals, literals + literalCount);
+    if (matchLength == 0) return;  // Final literal run
+
+    out.push_back(static_cast<uint8_t>(offset & 0xFF));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (matchCode >= 15) writeLength(out, matchCode - 15);
+}
+
+std::vector<uint8_t> lzCompress(const uint8_t* src, size_t size) {
+    std::vector<uint8_t> out;
+    out.reserve(size / 2 + 16);
+
+    std::vector<uint32_t> table(size_t{1} << HASH_BITS, 0);  // Position + 1, 0 = empty
+    size_t anchor = 0;
+    size_t ip = 0;
+    if (size > MATCH_SEARCH_END) {
+        const size_t searchEnd = size - MATCH_SEARCH_END;
+        const size_t matchEnd = size - LAST_LITERALS;
+        while (ip < searchEnd) {
+            const uint32_t seq = read32(src + ip);
+            const uint32_t h = hash32(seq);
+            const size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(ip + 1);
+
+            if (candidate != 0 && ip - (candidate - 1) <= MAX_OFFSET && read32(src + candidate - 1) == seq) {
+                const size_t ref = candidate - 1;
+                size_t length = MIN_MATCH;
+                while (ip + length < matchEnd && src[ref + length] == src[ip + length]) {
+                    ++length;
+                }
+                emitSequence(out, src + anchor, ip - anchor, ip - ref, length);
+                ip += length;
+                anchor = ip;
+            } else {
+                ++ip;
+            }
+        }
+    }
+    emitSequence(out, src + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+size_t readLength(const uint8_t*& ip, const uint8_t* end) {
+    size_t length = 0;
+    uint8_t b;
+    do {
+        if (ip >= end) throw std::runtime_error("Corrupt compressed block");
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return length;
+}
+
+void lzDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    const uint8_t* ip = src;
+    const uint8_t* const end = src + srcSize;
+    size_t op = 0;
+
+    while (ip < end) {
+        const uint8_t token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15) literals += readLength(ip, end);
+        if (literals > static_cast<size_t>(end - ip) || literals > dstSize - op) {
+            throw std::runtime_error("Corrupt compressed block");
+        }
+        std::memcpy(dst + op, ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == end) break;  // Final literal run
+
+        if (end - ip < 2) throw std::runtime_error("Corrupt compressed block");
+        const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        size_t length = (token & 15);
+        if (length == 15) length += readLength(ip, end);
+        length += MIN_MATCH;
+        if (offset == 0 || offset > op || length > dstSize - op) {
+            throw std::runtime_error("Corrupt compressed block");
+        }
+        // Byte copy: matches may overlap their own output
+        const uint8_t* match = dst + op - offset;
+        for (size_t i = 0; i < length; ++i) {
+            dst[op + i] = match[i];
+        }
+        op += length;
+    }
+    if (op != dstSize) throw std::runtime_error("Compressed block has the wrong size");
+}
+
+// XOR each value with its predecessor, then group bytes by significance
+void deltaShuffle(const uint8_t* src, size_t size, size_t elementSize, uint8_t* dst) {
+    const size_t count = size / elementSize;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* value = src + i * elementSize;
+        for (size_t b = 0; b < elementSize; ++b) {
+            const uint8_t prev = i ? value[b - elementSize] : 0;
+            dst[b * count + i] = value[b] ^ prev;
+        }
+    }
+    // Partial trailing element, if any, is copied as is
+    std::memcpy(dst + count * elementSize, src + count * elementSize, size - count * elementSize);
+}
+
+void unshuffleDelta(const uint8_t* src, size_t size, size_t elementSize, uint8_t* dst) {
+    const size_t count = size / elementSize;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t* value = dst + i * elementSize;
+        for (size_t b = 0; b < elementSize; ++b) {
+            const uint8_t prev = i ? value[b - elementSize] : 0;
+            value[b] = src[b * count + i] ^ prev;
+        }
+    }
+    std::memcpy(dst + count * elementSize, src + count * elementSize, size - count * elementSize);
+}
+
+} // namespace
+
+Block compressBlock(const uint8_t* data, size_t size, size_t elementSize) {
+    std::vector<uint8_t> shuffled(size);
+    deltaShuffle(data, size, elementSize, shuffled.data());
+
+    Block block;
+    block.bytes = lzCompress(shuffled.data(), size);
+    if (block.bytes.size() >= size) {
+        block.bytes.assign(data, data + size);
+        block.raw = true;
+    }
+    return block;
+}
+
+void decompressBlock(const uint8_t* src, size_t srcSize, bool raw,
+                     uint8_t* dst, size_t dstSize, size_t elementSize) {
+    if (raw) {
+        if (srcSize != dstSize) throw std::runtime_error("Raw block has the wrong size");
+        std::memcpy(dst, src, dstSize);
+        return;
+    }
+    std::vector<uint8_t> shuffled(dstSize);
+    lzDecompress(src, srcSize, shuffled.data(), dstSize);
+    unshuffleDelta(shuffled.data(), dstSize, elementSize, dst);
+}
+
+void compressBlocks(const uint8_t* values, size_t elementCount, size_t elementSize,
+                    size_t firstBlock, size_t count, Block* out) {
+    JobSystem::get().parallelFor(count, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            const size_t block = firstBlock + i;
+            const size_t first = block * BLOCK_ELEMENTS;
+            const size_t last = std::min(elementCount, first + BLOCK_ELEMENTS);
+            out[i] = compressBlock(values + first * elementSize, (last - first) * elementSize, elementSize);
+        }
+    });
+}
+
+void writeSection(BinaryWriter& writer, size_t elementCount, size_t elementSize,
+                  const std::vector<Block>& blocks) {
+    writer.WriteUint32(static_cast<uint32_t>(elementCount));
+    writer.WriteUint32(static_cast<uint32_t>(elementSize));
+    writer.WriteUint32(BLOCK_ELEMENTS);
+    writer.WriteUint32(static_cast<uint32_t>(blocks.size()));
+    for (const Block& block : blocks) {
+        writer.WriteUint32(static_cast<uint32_t>(block.bytes.size()) | (block.raw ? RAW_BLOCK_FLAG : 0));
+    }
+    for (const Block& block : blocks) {
+        writer.WriteBytes(block.bytes.data(), block.bytes.size());
+    }
+}
+
+Directory readDirectory(BinaryReader& reader, size_t elementSize) {
+    Directory dir;
+    dir.elementCount = reader.ReadUint32();
+    dir.elementSize = reader.ReadUint32();
+    dir.blockElements = reader.ReadUint32();
+    const uint32_t blockCount = reader.ReadUint32();
+
+    // Blocks larger than the writer's would let a tiny directory claim a
+    // huge element count
+    if (dir.elementSize != elementSize || dir.blockElements == 0 || dir.blockElements > BLOCK_ELEMENTS) {
+        throw std::runtime_error("Unsupported section layout");
+    }
+    // elementCount comes from the file and sizes the caller's output, so
+    // check it against what the remaining bytes could possibly hold
+    const size_t expectedBlocks = (static_cast<size_t>(dir.elementCount) + dir.blockElements - 1) / dir.blockElements;
+    if (blockCount != expectedBlocks ||
+        expectedBlocks * MIN_BLOCK_BYTES > reader.GetSize() - reader.GetPosition()) {
+        throw std::out_of_range("Section directory exceeds buffer size");
+    }
+
+    dir.storedSizes.resize(blockCount);
+    dir.raw.resize(blockCount);
+    dir.offsets.resize(blockCount);
+    for (uint32_t i = 0; i < blockCount; ++i) {
+        const uint32_t entry = reader.ReadUint32();
+        dir.storedSizes[i] = entry & ~RAW_BLOCK_FLAG;
+        dir.raw[i] = (entry & RAW_BLOCK_FLAG) != 0;
+        dir.offsets[i] = dir.dataSize;
+        dir.dataSize += dir.storedSizes[i];
+    }
+    if (dir.dataSize > reader.GetSize() - reader.GetPosition()) {
+        throw std::out_of_range("Section data exceeds buffer size");
+    }
+    if (static_cast<uint64_t>(dir.elementCount) * dir.elementSize > dir.dataSize * MAX_EXPANSION) {
+        throw std::runtime_error("Section claims more data than its blocks can hold");
+    }
+    return dir;
+}
+
+void decompressBlocks(const Directory& directory, const uint8_t* data,
+                      size_t firstBlock, size_t count, uint8_t* values) {
+    const size_t elementSize = directory.elementSize;
+
+    // Corrupt blocks throw; catch on the worker and rethrow on the caller
+    std::mutex errorMutex;
+    std::string error;
+    JobSystem::get().parallelFor(count, [&](size_t begin, size_t end, unsigned) {
+        try {
+            for (size_t i = begin; i < end; ++i) {
+                const size_t block = firstBlock + i;
+                const size_t first = directory.blockBegin(block);
+                const size_t last = directory.blockEnd(block);
+                decompressBlock(data + directory.offsets[block], directory.storedSizes[block], directory.raw[block] != 0,
+                                values + first * elementSize, (last - first) * elementSize, elementSize);
+            }
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (error.empty()) error = e.what();
+        }
+    });
+    if (!error.empty()) throw std::runtime_error(error);
+}
+
+} // namespace BlockCompression
+
+} // namespace EvolutionSim
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Serialization.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace EvolutionSim {
+
+// Block-parallel compression for large save sections.
+//
+// A section of fixed-size values is split into blocks of BLOCK_ELEMENTS that
+// are compressed independently, so blocks encode and decode in parallel on
+// the job system and a reader can start on a block as soon as its bytes have
+// arrived. The section directory in front of the data records each block's
+// compressed size.
+//
+// Per block, values are XOR-delta coded against their predecessor and byte
+// shuffled (all first bytes, then all second bytes, ...), which turns smooth
+// numeric fields into long runs, then packed with a small LZ77 coder. Blocks
+// that do not shrink are stored raw.
+//
+// Section layout:
+//     u32 element count
+//     u32 element size
+//     u32 elements per block
+//     u32 block count
+//     u32 stored size per block (high bit set: stored raw)
+//     block bytes, concatenated
+namespace BlockCompression {
+
+constexpr uint32_t BLOCK_ELEMENTS = 65536;
+constexpr uint32_t RAW_BLOCK_FLAG = 0x80000000u;
+
+struct Block {
+    std::vector<uint8_t> bytes;
+    bool raw = false;
+};
+
+struct Directory {
+    uint32_t elementCount = 0;
+    uint32_t elementSize = 0;
+    uint32_t blockElements = 0;
+    std::vector<uint32_t> storedSizes;  // Without the raw flag
+    std::vector<uint8_t> raw;
+    std::vector<size_t> offsets;        // Of each block from the start of the block data
+    size_t dataSize = 0;
+
+    size_t blockCount() const { return storedSizes.size(); }
+    size_t blockBegin(size_t block) const { return block * blockElements; }
+    size_t blockEnd(size_t block) const {
+        return std::min<size_t>(elementCount, (block + 1) * static_cast<size_t>(blockElements));
+    }
+};
+
+inline size_t blockCountFor(size_t elementCount) {
+    return (elementCount + BLOCK_ELEMENTS - 1) / BLOCK_ELEMENTS;
+}
+
+// Single-block codec. `data` holds size / elementSize values.
+Block compressBlock(const uint8_t* data, size_t size, size_t elementSize);
+void decompressBlock(const uint8_t* src, size_t srcSize, bool raw,
+                     uint8_t* dst, size_t dstSize, size_t elementSize);
+
+// Compress blocks [firstBlock, firstBlock + count) of `values` into out[0..count)
+// in parallel
+void compressBlocks(const uint8_t* values, size_t elementCount, size_t elementSize,
+                    size_t firstBlock, size_t count, Block* out);
+
+// Directory plus block bytes
+void writeSection(BinaryWriter& writer, size_t elementCount, size_t elementSize,
+                  const std::vector<Block>& blocks);
+
+// Read the directory and leave the reader at the first block byte. Throws
+// if the directory does not fit the buffer or does not match `elementSize`.
+Directory readDirectory(BinaryReader& reader, size_t elementSize);
+
+// Decode blocks [firstBlock, firstBlock + count) in parallel. `data` points
+// at the first block byte; `values` receives the whole section.
+void decompressBlocks(const Directory& directory, const uint8_t* data,
+                      size_t firstBlock, size_t count, uint8_t* values);
+
+} // namespace BlockCompression
+
+} // namespace EvolutionSim
@@ -0,0 +1,419 @@
+#include "ColumnarWriter.hpp"
+#include "Logging.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace EvolutionSim {
+
+namespace {
+
+// Arrow IPC constants (format/Message.fbs, format/Schema.fbs)
+constexpr int16_t METADATA_V5 = 4;
+constexpr uint8_t HEADER_SCHEMA = 1;
+constexpr uint8_t HEADER_DICTIONARY_BATCH = 2;
+constexpr uint8_t HEADER_RECORD_BATCH = 3;
+constexpr uint8_t TYPE_INT = 2;
+constexpr uint8_t TYPE_FLOATING_POINT = 3;
+constexpr uint8_t TYPE_UTF8 = 5;
+constexpr int16_t PRECISION_DOUBLE = 2;
+constexpr uint32_t CONTINUATION = 0xFFFFFFFFu;
+
+// Minimal FlatBuffers encoder, written front to back: a table is laid out
+// before the objects it references, so every offset points forward as the
+// format requires. Positions are byte offsets from the buffer start.
+class FlatBuilder {
+public:
+    using ChildFn = std::function<size_t(FlatBuilder&)>;
+
+    struct Field {
+        uint16_t slot;
+        uint8_t size;       // 1, 2, 4 or 8; offsets are 4
+        uint64_t value;     // Scalars
+        ChildFn child;      // Set for offset fields
+    };
+
+    static Field scalar(uint16_t slot, uint8_t size, uint64_t value) { return {slot, size, value, nullptr}; }
+    static Field offset(uint16_t slot, ChildFn child) { return {slot, 4, 0, std::move(child)}; }
+
+    // Root table at offset 0; the result is padded to 8 bytes
+    std::vector<uint8_t> finish(const ChildFn& root) {
+        put<uint32_t>(0);
+        patchOffset(0, root(*this));
+        pad(8);
+        return std::move(m_bytes);
+    }
+
+    size_t table(std::vector<Field> fields) {
+        // Widest fields first so each lands aligned to its size
+        std::stable_sort(fields.begin(), fields.end(),
+                         [](const Field& a, const Field& b) { return a.size > b.size; });
+        uint16_t slots = 0;
+        std::vector<uint16_t> positions(fields.size());
+        size_t inlineSize = 4;  // soffset to the vtable
+        for (size_t i = 0; i < fields.size(); ++i) {
+            slots = std::max<uint16_t>(slots, fields[i].slot + 1);
+            inlineSize = (inlineSize + fields[i].size - 1) / fields[i].size * fields[i].size;
+            positions[i] = static_cast<uint16_t>(inlineSize);
+            inlineSize += fields[i].size;
+        }
+
+        // vtable directly in front of the table, table start 8-aligned
+        const size_t vtableSize = 4 + 2 * static_cast<size_t>(slots);
+        pad(2);
+        while ((m_bytes.size() + vtableSize) % 8 != 0) put<uint16_t>(0);
+        const size_t vtable = m_bytes.size();
+        put<uint16_t>(static_cast<uint16_t>(vtableSize));
+        put<uint16_t>(static_cast<uint16_t>(inlineSize));
+        m_bytes.resize(m_bytes.size() + 2 * static_cast<size_t>(slots), 0);
+        for (size_t i = 0; i < fields.size(); ++i) {
+            putAt<uint16_t>(vtable + 4 + 2 * fields[i].slot, positions[i]);
+        }
+
+        const size_t start = m_bytes.size();
+        m_bytes.resize(start + inlineSize, 0);
+        putAt<int32_t>(start, static_cast<int32_t>(start - vtable));
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (!fields[i].child) {
+                std::memcpy(m_bytes.data() + start + positions[i], &fields[i].value, fields[i].size);
+            }
+        }
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (fields[i].child) {
+                const size_t at = start + positions[i];
+                patchOffset(at, fields[i].child(*this));
+            }
+        }
+        return start;
+    }
+
+    // Vector of 16-byte structs (FieldNode, Buffer) with 8-aligned elements
+    size_t structVector(const std::vector<int64_t>& pairs) {
+        pad(4);
+        while ((m_bytes.size() + 4) % 8 != 0) put<uint32_t>(0);
+        const size_t start = m_bytes.size();
+        put<uint32_t>(static_cast<uint32_t>(pairs.size() / 2));
+        for (int64_t v : pairs) put<int64_t>(v);
+        return start;
+    }
+
+    size_t tableVector(const std::vector<ChildFn>& tables) {
+        pad(4);
+        const size_t start = m_bytes.size();
+        put<uint32_t>(static_cast<uint32_t>(tables.size()));
+        m_bytes.resize(m_bytes.size() + 4 * tables.size(), 0);
+        for (size_t i = 0; i < tables.size(); ++i) {
+            const size_t at = start + 4 + 4 * i;
+            patchOffset(at, tables[i](*this));
+        }
+        return start;
+    }
+
+    size_t string(const std::string& s) {
+        pad(4);
+        const size_t start = m_bytes.size();
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        m_bytes.insert(m_bytes.end(), s.begin(), s.end());
+        m_bytes.push_back(0);
+        return start;
+    }
+
+private:
+    template <typename T>
+    void put(T value) {
+        const size_t at = m_bytes.size();
+        m_bytes.resize(at + sizeof(T));
+        std::memcpy(m_bytes.data() + at, &value, sizeof(T));
+    }
+
+    template <typename T>
+    void putAt(size_t at, T value) { std::memcpy(m_bytes.data() + at, &value, sizeof(T)); }
+
+    void patchOffset(size_t at, size_t target) { putAt<uint32_t>(at, static_cast<uint32_t>(target - at)); }
+
+    void pad(size_t align) {
+        while (m_bytes.size() % align != 0) m_bytes.push_back(0);
+    }
+
+    std::vector<uint8_t> m_bytes;
+};
+
+using Field = FlatBuilder::Field;
+
+// Message body: buffers back to back, each padded to 8 bytes
+struct Body {
+    std::vector<uint8_t> bytes;
+    std::vector<int64_t> buffers;  // (offset, length) pairs
+    std::vector<int64_t> nodes;    // (length, null count) pairs
+
+    void addBuffer(const void* data, size_t size) {
+        buffers.push_back(static_cast<int64_t>(bytes.size()));
+        buffers.push_back(static_cast<int64_t>(size));
+        const auto* p = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), p, p + size);
+        bytes.resize((bytes.size() + 7) / 8 * 8, 0);
+    }
+
+    // No nulls anywhere, so validity bitmaps are always empty
+    void addNode(size_t length) {
+        nodes.push_back(static_cast<int64_t>(length));
+        nodes.push_back(0);
+        addBuffer(nullptr, 0);
+    }
+
+    void addStrings(const std::vector<std::string>& strings) {
+        addNode(strings.size());
+        std::vector<int32_t> offsets(1, 0);
+        std::vector<uint8_t> data;
+        for (const auto& s : strings) {
+            data.insert(data.end(), s.begin(), s.end());
+            offsets.push_back(static_cast<int32_t>(data.size()));
+        }
+        addBuffer(offsets.data(), offsets.size() * sizeof(int32_t));
+        addBuffer(data.data(), data.size());
+    }
+};
+
+FlatBuilder::ChildFn intType(int32_t bitWidth) {
+    return [bitWidth](FlatBuilder& b) {
+        return b.table({FlatBuilder::scalar(0, 4, static_cast<uint32_t>(bitWidth)),
+                        FlatBuilder::scalar(1, 1, 1)});
+    };
+}
+
+FlatBuilder::ChildFn recordBatchTable(size_t rows, const Body& body) {
+    return [rows, &body](FlatBuilder& b) {
+        return b.table({FlatBuilder::scalar(0, 8, rows),
+                        FlatBuilder::offset(1, [&body](FlatBuilder& b) { return b.structVector(body.nodes); }),
+                        FlatBuilder::offset(2, [&body](FlatBuilder& b) { return b.structVector(body.buffers); })});
+    };
+}
+
+std::vector<uint8_t> message(uint8_t headerType, const FlatBuilder::ChildFn& header, size_t bodyLength) {
+    FlatBuilder builder;
+    return builder.finish([&](FlatBuilder& b) {
+        return b.table({FlatBuilder::scalar(0, 2, static_cast<uint16_t>(METADATA_V5)),
+                        FlatBuilder::scalar(1, 1, headerType),
+                        FlatBuilder::offset(2, header),
+                        FlatBuilder::scalar(3, 8, bodyLength)});
+    });
+}
+
+std::vector<uint8_t> schemaMessage(const std::vector<ColumnarWriter::Column>& columns) {
+    std::vector<FlatBuilder::ChildFn> fields;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        const auto& column = columns[i];
+        fields.push_back([&column, i](FlatBuilder& b) {
+            std::vector<Field> f = {
+                FlatBuilder::offset(0, [&column](FlatBuilder& b) { return b.string(column.name); }),
+                FlatBuilder::scalar(1, 1, 0),
+                FlatBuilder::offset(5, [](FlatBuilder& b) { return b.tableVector({}); })
+            };
+            switch (column.type) {
+                case ColumnarWriter::ColumnType::Int64:
+                    f.push_back(FlatBuilder::scalar(2, 1, TYPE_INT));
+                    f.push_back(FlatBuilder::offset(3, intType(64)));
+                    break;
+                case ColumnarWriter::ColumnType::Float64:
+                    f.push_back(FlatBuilder::scalar(2, 1, TYPE_FLOATING_POINT));
+                    f.push_back(FlatBuilder::offset(3, [](FlatBuilder& b) {
+                        return b.table({FlatBuilder::scalar(0, 2, static_cast<uint16_t>(PRECISION_DOUBLE))});
+                    }));
+                    break;
+                case ColumnarWriter::ColumnType::String:
+                    // Dictionary id is the column index
+                    f.push_back(FlatBuilder::scalar(2, 1, TYPE_UTF8));
+                    f.push_back(FlatBuilder::offset(3, [](FlatBuilder& b) { return b.table({}); }));
+                    f.push_back(FlatBuilder::offset(4, [i](FlatBuilder& b) {
+                        return b.table({FlatBuilder::scalar(0, 8, i), FlatBuilder::offset(1, intType(32))});
+                    }));
+                    break;
+            }
+            return b.table(std::move(f));
+        });
+    }
+
+    return message(HEADER_SCHEMA, [&fields](FlatBuilder& b) {
+        return b.table({FlatBuilder::scalar(0, 2, 0),  // Little endian
+                        FlatBuilder::offset(1, [&fields](FlatBuilder& b) { return b.tableVector(fields); })});
+    }, 0);
+}
+
+} // namespace
+
+ColumnarWriter::ColumnarWriter(const std::string& filename, std::vector<Column> columns, size_t batchRows)
+    : m_columns(std::move(columns)),
+      m_batchRows(std::max<size_t>(1, batchRows)),
+      m_dictionaries(m_columns.size()) {
+    m_file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        LOG_ERROR("Could not open analytics file: " + filename);
+        return;
+    }
+
+    StartBatch();
+
+    // Index 0 of every dictionary is "", the value of unset cells
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        if (m_columns[c].type == ColumnType::String) {
+            m_dictionaries[c].emplace(std::string(), 0);
+            m_batch.columns[c].newStrings.emplace_back();
+        }
+    }
+
+    WriteMessage(schemaMessage(m_columns), {});
+    m_open = true;
+    m_thread = std::thread(&ColumnarWriter::WriterLoop, this);
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    Close();
+}
+
+void ColumnarWriter::StartBatch() {
+    m_batch.rows = 0;
+    m_batch.columns.assign(m_columns.size(), ColumnData());
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        switch (m_columns[c].type) {
+            case ColumnType::Int64: m_batch.columns[c].ints.resize(m_batchRows); break;
+            case ColumnType::Float64: m_batch.columns[c].doubles.resize(m_batchRows); break;
+            case ColumnType::String: m_batch.columns[c].indices.resize(m_batchRows); break;
+        }
+    }
+}
+
+ColumnarWriter::ColumnData& ColumnarWriter::Slot(size_t column, ColumnType type) {
+    if (column >= m_columns.size() || m_columns[column].type != type) {
+        throw std::invalid_argument("Column type mismatch");
+    }
+    return m_batch.columns[column];
+}
+
+void ColumnarWriter::SetInt(size_t column, int64_t value) {
+    if (!m_open) return;
+    Slot(column, ColumnType::Int64).ints[m_batch.rows] = value;
+}
+
+void ColumnarWriter::SetDouble(size_t column, double value) {
+    if (!m_open) return;
+    Slot(column, ColumnType::Float64).doubles[m_batch.rows] = value;
+}
+
+void ColumnarWriter::SetString(size_t column, const std::string& value) {
+    if (!m_open) return;
+    ColumnData& data = Slot(column, ColumnType::String);
+    auto& dictionary = m_dictionaries[column];
+    auto it = dictionary.find(value);
+    if (it == dictionary.end()) {
+        it = dictionary.emplace(value, static_cast<int32_t>(dictionary.size())).first;
+        data.newStrings.push_back(value);
+    }
+    data.indices[m_batch.rows] = it->second;
+}
+
+void ColumnarWriter::EndRow() {
+    if (!m_open) return;
+    ++m_rowCount;
+    if (++m_batch.rows == m_batchRows) {
+        Flush();
+    }
+}
+
+void ColumnarWriter::Flush() {
+    if (!m_open || m_batch.rows == 0) return;
+
+    for (auto& column : m_batch.columns) {
+        if (!column.ints.empty()) column.ints.resize(m_batch.rows);
+        if (!column.doubles.empty()) column.doubles.resize(m_batch.rows);
+        if (!column.indices.empty()) column.indices.resize(m_batch.rows);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(m_batch));
+    }
+    m_wake.notify_one();
+    StartBatch();
+}
+
+void ColumnarWriter::Close() {
+    if (!m_open) return;
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    // End-of-stream marker
+    const uint32_t eos[2] = {CONTINUATION, 0};
+    m_file.write(reinterpret_cast<const char*>(eos), sizeof(eos));
+    m_file.close();
+    m_open = false;
+}
+
+void ColumnarWriter::WriterLoop() {
+    for (;;) {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_closing || !m_pending.empty(); });
+            if (m_pending.empty()) return;
+            batch = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+        if (!m_failed) {
+            WriteBatch(batch);
+        }
+    }
+}
+
+void ColumnarWriter::WriteBatch(const Batch& batch) {
+    // Dictionaries: all of them in full before the first record batch, then
+    // only deltas
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        if (m_columns[c].type != ColumnType::String) continue;
+        const auto& strings = batch.columns[c].newStrings;
+        if (m_wroteDictionaries && strings.empty()) continue;
+
+        Body body;
+        body.addStrings(strings);
+        const bool isDelta = m_wroteDictionaries;
+        WriteMessage(message(HEADER_DICTIONARY_BATCH, [&](FlatBuilder& b) {
+            return b.table({FlatBuilder::scalar(0, 8, c),
+                            FlatBuilder::offset(1, recordBatchTable(strings.size(), body)),
+                            FlatBuilder::scalar(2, 1, isDelta ? 1 : 0)});
+        }, body.bytes.size()), body.bytes);
+    }
+    m_wroteDictionaries = true;
+
+    Body body;
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        const ColumnData& data = batch.columns[c];
+        body.addNode(batch.rows);
+        switch (m_columns[c].type) {
+            case ColumnType::Int64: body.addBuffer(data.ints.data(), data.ints.size() * sizeof(int64_t)); break;
+            case ColumnType::Float64: body.addBuffer(data.doubles.data(), data.doubles.size() * sizeof(double)); break;
+            case ColumnType::String: body.addBuffer(data.indices.data(), data.indices.size() * sizeof(int32_t)); break;
+        }
+    }
+    WriteMessage(message(HEADER_RECORD_BATCH, recordBatchTable(batch.rows, body), body.bytes.size()), body.bytes);
+
+    m_file.flush();
+    if (!m_file.good()) {
+        LOG_ERROR("Failed writing analytics batch; further rows are dropped");
+        m_failed = true;
+    }
+}
+
+void ColumnarWriter::WriteMessage(const std::vector<uint8_t>& metadata, const std::vector<uint8_t>& body) {
+    // Encapsulated message: continuation marker, metadata size, metadata
+    // (already padded to 8 bytes), body
+    const uint32_t prefix[2] = {CONTINUATION, static_cast<uint32_t>(metadata.size())};
+    m_file.write(reinterpret_cast<const char*>(prefix), sizeof(prefix));
+    m_file.write(reinterpret_cast<const char*>(metadata.data()), metadata.size());
+    m_file.write(reinterpret_cast<const char*>(body.data()), body.size());
+}
+
+} // namespace EvolutionSim
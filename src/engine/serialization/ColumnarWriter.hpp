@@ -0,0 +1,111 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace EvolutionSim {
+
+// Appends rows of per-tick statistics to an Arrow IPC stream (".arrows"),
+// which loads directly into dataframe tools: pyarrow.ipc.open_stream,
+// polars.read_ipc_stream, DuckDB and R arrow.
+//
+// Rows are buffered column-wise on the calling thread. Every `batchRows`
+// rows the batch is handed to a background thread that encodes it as an
+// Arrow record batch and writes it, so the tick only pays for the appends.
+// String columns are dictionary-encoded: a batch is preceded by a delta
+// dictionary batch carrying just the strings first seen in it. A stream cut
+// short by a crash stays readable up to its last complete batch.
+class ColumnarWriter {
+public:
+    enum class ColumnType {
+        Int64,
+        Float64,
+        String    // Dictionary-encoded utf8 with int32 indices
+    };
+
+    struct Column {
+        std::string name;
+        ColumnType type;
+    };
+
+    static constexpr size_t DEFAULT_BATCH_ROWS = 4096;
+
+    // Opens the file and writes the schema. On failure the error is logged,
+    // IsOpen() is false and rows are dropped.
+    ColumnarWriter(const std::string& filename, std::vector<Column> columns,
+                   size_t batchRows = DEFAULT_BATCH_ROWS);
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    bool IsOpen() const { return m_open; }
+
+    // Set a value in the current row. Columns left unset read 0 or "".
+    // Throws std::invalid_argument if the column has another type.
+    void SetInt(size_t column, int64_t value);
+    void SetDouble(size_t column, double value);
+    void SetString(size_t column, const std::string& value);
+
+    // Finish the current row; hands the batch off once it is full
+    void EndRow();
+
+    // Hand off the rows so far, even if the batch is not full
+    void Flush();
+
+    // Flush, wait for the writer thread and end the stream. The destructor
+    // calls this too.
+    void Close();
+
+    // Rows finished with EndRow()
+    uint64_t GetRowCount() const { return m_rowCount; }
+
+private:
+    struct ColumnData {
+        std::vector<int64_t> ints;
+        std::vector<double> doubles;
+        std::vector<int32_t> indices;
+        std::vector<std::string> newStrings;  // Dictionary entries first used in this batch
+    };
+
+    struct Batch {
+        size_t rows = 0;
+        std::vector<ColumnData> columns;
+    };
+
+    void StartBatch();
+    ColumnData& Slot(size_t column, ColumnType type);
+    void WriterLoop();
+    void WriteBatch(const Batch& batch);
+    void WriteMessage(const std::vector<uint8_t>& metadata, const std::vector<uint8_t>& body);
+
+    std::vector<Column> m_columns;
+    size_t m_batchRows;
+    uint64_t m_rowCount = 0;
+    bool m_open = false;
+
+    // Calling thread
+    Batch m_batch;
+    std::vector<std::unordered_map<std::string, int32_t>> m_dictionaries;
+
+    // Writer thread
+    std::ofstream m_file;
+    bool m_wroteDictionaries = false;
+    bool m_failed = false;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<Batch> m_pending;
+    bool m_closing = false;
+};
+
+} // namespace EvolutionSim
@@ -1,4 +1,5 @@
 #include "SaveSystem.hpp"
+#include "SaveTasks.hpp"
 #include "TemperatureSystem.hpp"
 #include <fstream>
 #include <stdexcept>
@@ -10,37 +11,24 @@ std::vector<uint8_t> SaveSystem::SaveGame(
     const TemperatureSystem& tempSystem,
     double simulationTime
 ) {
-    GameSaveData saveData;
-    
-    // Set metadata
-    saveData.saveName = saveName;
-    saveData.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-    saveData.version = CURRENT_VERSION;
-    
-    // Set world data
-    const auto& grid = tempSystem.getGrid();
-    saveData.world.width = grid.width;
-    saveData.world.height = grid.height;
-    saveData.world.simulationTime = simulationTime;
-    
-    // Set temperature data
-    saveData.temperatureData.ambientTemperature = grid.ambientTemperature;
-    saveData.temperatureData.temperatures = GetTemperatureData(tempSystem);
-    
-    // TODO: Add creature data when available
-    
-    // Serialize to binary
-    return Serialize(saveData);
+    // Same code path as the time-sliced save, run in one go
+    SaveGameTask task(saveName, tempSystem, simulationTime);
+    if (task.runToCompletion() != ResumableTask::Status::Done) {
+        throw std::runtime_error("Failed to save game: " + task.getError());
+    }
+    return task.takeResult();
 }
 
 std::unique_ptr<GameSaveData> SaveSystem::LoadGame(const uint8_t* data, size_t size) {
-    auto saveData = std::make_unique<GameSaveData>();
-    try {
-        Deserialize(*saveData, data, size);
-        return saveData;
-    } catch (const std::exception& e) {
-        throw std::runtime_error(std::string("Failed to load game: ") + e.what());
+    return LoadGame(std::vector<uint8_t>(data, data + size));
+}
+
+std::unique_ptr<GameSaveData> SaveSystem::LoadGame(std::vector<uint8_t>&& data) {
+    LoadGameTask task(std::move(data));
+    if (task.runToCompletion() != ResumableTask::Status::Done) {
+        throw std::runtime_error("Failed to load game: " + task.getError());
     }
+    return task.takeResult();
 }
 
 bool SaveSystem::SaveToFile(const std::string& filename, const std::vector<uint8_t>& data) {
@@ -70,18 +58,4 @@ std::vector<uint8_t> SaveSystem::LoadFromFile(const std::string& filename) {
     return buffer;
 }
 
-std::vector<double> SaveSystem::GetTemperatureData(const TemperatureSystem& tempSystem) const {
-    const auto& grid = tempSystem.getGrid();
-    std::vector<double> temps;
-    temps.reserve(grid.width * grid.height);
-    
-    for (uint32_t y = 0; y < grid.height; ++y) {
-        for (uint32_t x = 0; x < grid.width; ++x) {
-            temps.push_back(tempSystem.getTemperature(x, y));
-        }
-    }
-    
-    return temps;
-}
-
 } // namespace EvolutionSim
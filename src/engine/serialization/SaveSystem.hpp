@@ -1,15 +1,17 @@
 #pragma once
 
 #include "Serialization.hpp"
+#include "BlockCompression.hpp"
+#include "genetics/GenomeStore.hpp"
 #include <string>
 #include <vector>
 #include <memory>
 
-namespace EvolutionSim {
-
 // Forward declarations
 class TemperatureSystem;
 
+namespace EvolutionSim {
+
 // Save data structure
 struct GameSaveData : public ISerializable {
     // Metadata
@@ -31,47 +33,67 @@ struct GameSaveData : public ISerializable {
         
         void Serialize(BinaryWriter& writer) const {
             writer.WriteDouble(ambientTemperature);
-            writer.WriteUint32(static_cast<uint32_t>(temperatures.size()));
-            for (double temp : temperatures) {
-                writer.WriteDouble(temp);
-            }
+            std::vector<BlockCompression::Block> blocks(BlockCompression::blockCountFor(temperatures.size()));
+            BlockCompression::compressBlocks(reinterpret_cast<const uint8_t*>(temperatures.data()),
+                                             temperatures.size(), sizeof(double), 0, blocks.size(), blocks.data());
+            BlockCompression::writeSection(writer, temperatures.size(), sizeof(double), blocks);
         }
         
-        void Deserialize(BinaryReader& reader) {
+        void Deserialize(BinaryReader& reader, uint16_t formatVersion = CURRENT_VERSION) {
             ambientTemperature = reader.ReadDouble();
-            uint32_t count = reader.ReadUint32();
-            temperatures.resize(count);
-            for (uint32_t i = 0; i < count; ++i) {
-                temperatures[i] = reader.ReadDouble();
+            if (formatVersion <= RAW_SECTIONS_VERSION) {
+                uint32_t count = reader.ReadUint32();
+                temperatures.resize(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    temperatures[i] = reader.ReadDouble();
+                }
+                return;
             }
+            const auto directory = BlockCompression::readDirectory(reader, sizeof(double));
+            temperatures.resize(directory.elementCount);
+            BlockCompression::decompressBlocks(directory, reader.GetCurrent(), 0, directory.blockCount(),
+                                               reinterpret_cast<uint8_t*>(temperatures.data()));
+            reader.Skip(directory.dataSize);
         }
     } temperatureData;
     
+    // Genomes, shared and delta-encoded; creatures refer to them by id
+    GenomeStore genomes;
+    
     // Creatures
     struct CreatureData {
         float x, y;
         float energy;
-        std::vector<uint8_t> dna;
+        GenomeStore::GenomeId genome = GenomeStore::NO_GENOME;  // Holds a reference
         
         void Serialize(BinaryWriter& writer) const {
             writer.WriteFloat(x);
             writer.WriteFloat(y);
             writer.WriteFloat(energy);
-            writer.WriteUint32(static_cast<uint32_t>(dna.size()));
-            if (!dna.empty()) {
-                writer.WriteBytes(dna.data(), dna.size());
+            writer.WriteUint32(genome);
+        }
+        
+        void Deserialize(BinaryReader& reader, const GenomeStore& store) {
+            x = reader.ReadFloat();
+            y = reader.ReadFloat();
+            energy = reader.ReadFloat();
+            genome = reader.ReadUint32();
+            if (genome != GenomeStore::NO_GENOME && !store.isValid(genome)) {
+                throw std::runtime_error("Creature refers to a missing genome");
             }
         }
         
-        void Deserialize(BinaryReader& reader) {
+        // Saves up to INLINE_DNA_VERSION store each creature's DNA inline
+        void DeserializeInlineDna(BinaryReader& reader, GenomeStore& store) {
             x = reader.ReadFloat();
             y = reader.ReadFloat();
             energy = reader.ReadFloat();
             uint32_t dnaSize = reader.ReadUint32();
-            dna.resize(dnaSize);
-            if (dnaSize > 0) {
-                reader.ReadBytes(dna.data(), dnaSize);
+            if (dnaSize > reader.GetSize() - reader.GetPosition()) {
+                throw std::out_of_range("DNA exceeds buffer size");
             }
+            genome = store.intern(reader.GetCurrent(), dnaSize);
+            reader.Skip(dnaSize);
         }
     };
     
@@ -92,7 +114,8 @@ struct GameSaveData : public ISerializable {
         // Write temperature data
         temperatureData.Serialize(writer);
         
-        // Write creatures
+        // Write genomes, then the creatures referring to them
+        genomes.Serialize(writer);
         writer.WriteUint32(static_cast<uint32_t>(creatures.size()));
         for (const auto& creature : creatures) {
             creature.Serialize(writer);
@@ -110,14 +133,22 @@ struct GameSaveData : public ISerializable {
         world.height = reader.ReadUint32();
         world.simulationTime = reader.ReadDouble();
         
-        // Read temperature data
-        temperatureData.Deserialize(reader);
+        // Read temperature data (`version` is the format the save was written in)
+        temperatureData.Deserialize(reader, static_cast<uint16_t>(version));
         
-        // Read creatures
+        // Read genomes and creatures
+        const bool inlineDna = version <= INLINE_DNA_VERSION;
+        if (!inlineDna) {
+            genomes.Deserialize(reader);
+        }
         uint32_t creatureCount = reader.ReadUint32();
         creatures.resize(creatureCount);
         for (uint32_t i = 0; i < creatureCount; ++i) {
-            creatures[i].Deserialize(reader);
+            if (inlineDna) {
+                creatures[i].DeserializeInlineDna(reader, genomes);
+            } else {
+                creatures[i].Deserialize(reader, genomes);
+            }
         }
     }
 };
@@ -127,25 +158,25 @@ public:
     SaveSystem() = default;
     ~SaveSystem() = default;
     
-    // Save the current game state
+    // Save the current game state. Blocks until done; SaveGameTask
+    // (SaveTasks.hpp) does the same work in frame-sized slices.
     std::vector<uint8_t> SaveGame(
         const std::string& saveName,
         const TemperatureSystem& tempSystem,
         double simulationTime
     );
     
-    // Load game state from binary data
+    // Load game state from binary data (LoadGameTask for the sliced version)
     std::unique_ptr<GameSaveData> LoadGame(const uint8_t* data, size_t size);
     
+    // Load from a buffer the caller hands over; parsed in place without a copy
+    std::unique_ptr<GameSaveData> LoadGame(std::vector<uint8_t>&& data);
+    
     // Save to file (platform-specific implementation needed)
     bool SaveToFile(const std::string& filename, const std::vector<uint8_t>& data);
     
     // Load from file (platform-specific implementation needed)
     std::vector<uint8_t> LoadFromFile(const std::string& filename);
-    
-private:
-    // Helper to convert temperature grid to flat array
-    std::vector<double> GetTemperatureData(const TemperatureSystem& tempSystem) const;
 };
 
 } // namespace EvolutionSim
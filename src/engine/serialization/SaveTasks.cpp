@@ -0,0 +1,216 @@
+#include "SaveTasks.hpp"
+#include "BlockCompression.hpp"
+#include "TemperatureSystem.hpp"
+#include "core/FlightRecorder.hpp"
+#include "core/JobSystem.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace EvolutionSim {
+
+namespace {
+
+// Work per advance() call: small enough that one unit is well under a
+// millisecond on slow devices
+constexpr size_t CELLS_PER_UNIT = 16384;
+constexpr size_t CREATURES_PER_UNIT = 1024;
+
+// Compressed sections advance one block per worker per unit
+size_t blocksPerUnit() {
+    return std::max<size_t>(1, JobSystem::get().getWorkerCount());
+}
+
+// Bytes one creature takes at least (before its DNA in inline-DNA saves)
+constexpr size_t CREATURE_FIXED_BYTES = 4 * sizeof(uint32_t);
+
+} // namespace
+
+SaveGameTask::SaveGameTask(const std::string& saveName, const TemperatureSystem& tempSystem, double simulationTime) {
+    m_snapshot.saveName = saveName;
+    m_snapshot.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    m_snapshot.version = CURRENT_VERSION;
+
+    const auto& grid = tempSystem.getGrid();
+    m_snapshot.world.width = grid.width;
+    m_snapshot.world.height = grid.height;
+    m_snapshot.world.simulationTime = simulationTime;
+
+    // Saves are always row-major so they load into any grid layout
+    m_snapshot.temperatureData.ambientTemperature = grid.ambientTemperature;
+    m_snapshot.temperatureData.temperatures.resize(static_cast<size_t>(grid.width) * grid.height);
+    tempSystem.copyTemperatures(m_snapshot.temperatureData.temperatures.data());
+
+    // TODO: Add creature data when available
+
+    FlightRecorder::record(FlightRecorder::EventType::Save, "save.begin", m_snapshot.temperatureData.temperatures.size());
+    setPhase("Saving header");
+}
+
+bool SaveGameTask::advance() {
+    const auto& temps = m_snapshot.temperatureData.temperatures;
+    switch (m_phase) {
+        case Phase::Header:
+            m_writer.Reserve(64 + m_snapshot.saveName.size() + temps.size() * sizeof(double) / 2);
+            m_writer.WriteUint32(SERIALIZATION_MAGIC);
+            m_writer.WriteUint16(CURRENT_VERSION);
+            m_writer.WriteString(m_snapshot.saveName);
+            m_writer.WriteUint64(m_snapshot.timestamp);
+            m_writer.WriteUint32(m_snapshot.version);
+            m_writer.WriteUint32(m_snapshot.world.width);
+            m_writer.WriteUint32(m_snapshot.world.height);
+            m_writer.WriteDouble(m_snapshot.world.simulationTime);
+            m_writer.WriteDouble(m_snapshot.temperatureData.ambientTemperature);
+            m_blocks.resize(BlockCompression::blockCountFor(temps.size()));
+            m_phase = Phase::Temperatures;
+            setPhase("Saving temperatures");
+            return false;
+
+        case Phase::Temperatures: {
+            const size_t count = std::min(m_blocks.size() - m_cursor, blocksPerUnit());
+            BlockCompression::compressBlocks(reinterpret_cast<const uint8_t*>(temps.data()), temps.size(),
+                                             sizeof(double), m_cursor, count, m_blocks.data() + m_cursor);
+            m_cursor += count;
+            setProgress(m_blocks.empty() ? 0.9 : 0.9 * static_cast<double>(m_cursor) / m_blocks.size());
+            if (m_cursor == m_blocks.size()) {
+                BlockCompression::writeSection(m_writer, temps.size(), sizeof(double), m_blocks);
+                m_blocks.clear();
+                m_phase = Phase::Genomes;
+                setPhase("Saving genomes");
+            }
+            return false;
+        }
+
+        case Phase::Genomes:
+            m_snapshot.genomes.Serialize(m_writer);
+            m_writer.WriteUint32(static_cast<uint32_t>(m_snapshot.creatures.size()));
+            m_cursor = 0;
+            m_phase = Phase::Creatures;
+            setPhase("Saving creatures");
+            return false;
+
+        case Phase::Creatures: {
+            const auto& creatures = m_snapshot.creatures;
+            const size_t end = std::min(creatures.size(), m_cursor + CREATURES_PER_UNIT);
+            for (; m_cursor < end; ++m_cursor) {
+                creatures[m_cursor].Serialize(m_writer);
+            }
+            if (m_cursor == creatures.size()) {
+                m_phase = Phase::Finish;
+            }
+            return false;
+        }
+
+        case Phase::Finish:
+            m_result = m_writer.TakeData();
+            FlightRecorder::record(FlightRecorder::EventType::Save, "save.done", m_result.size());
+            return true;
+    }
+    return true;
+}
+
+LoadGameTask::LoadGameTask(const uint8_t* data, size_t size)
+    : LoadGameTask(std::vector<uint8_t>(data, data + size)) {}
+
+LoadGameTask::LoadGameTask(std::vector<uint8_t>&& data)
+    : m_data(std::move(data)),
+      m_reader(m_data.data(), m_data.size()),
+      m_result(std::make_unique<GameSaveData>()) {
+    FlightRecorder::record(FlightRecorder::EventType::Load, "load.begin", m_data.size());
+    setPhase("Reading header");
+}
+
+bool LoadGameTask::advance() {
+    GameSaveData& save = *m_result;
+    switch (m_phase) {
+        case Phase::Header: {
+            m_reader.ValidateMagic();
+            m_reader.CheckVersion();
+            m_formatVersion = m_reader.ReadUint16();
+            save.saveName = m_reader.ReadString();
+            save.timestamp = m_reader.ReadUint64();
+            save.version = m_reader.ReadUint32();
+            save.world.width = m_reader.ReadUint32();
+            save.world.height = m_reader.ReadUint32();
+            save.world.simulationTime = m_reader.ReadDouble();
+            save.temperatureData.ambientTemperature = m_reader.ReadDouble();
+
+            if (m_formatVersion > RAW_SECTIONS_VERSION) {
+                // Block data is decoded straight out of the buffer, then skipped
+                m_directory = BlockCompression::readDirectory(m_reader, sizeof(double));
+                m_sectionData = m_reader.GetCurrent();
+                save.temperatureData.temperatures.resize(m_directory.elementCount);
+            } else {
+                // Check the count against the buffer before allocating for it
+                const uint32_t count = m_reader.ReadUint32();
+                if (static_cast<size_t>(count) * sizeof(double) > m_reader.GetSize() - m_reader.GetPosition()) {
+                    throw std::out_of_range("Temperature count exceeds buffer size");
+                }
+                save.temperatureData.temperatures.resize(count);
+            }
+            m_phase = Phase::Temperatures;
+            setPhase("Reading temperatures");
+            return false;
+        }
+
+        case Phase::Temperatures: {
+            auto& temps = save.temperatureData.temperatures;
+            size_t total = temps.size();
+            if (m_formatVersion > RAW_SECTIONS_VERSION) {
+                total = m_directory.blockCount();
+                const size_t count = std::min(total - m_cursor, blocksPerUnit());
+                BlockCompression::decompressBlocks(m_directory, m_sectionData, m_cursor, count,
+                                                   reinterpret_cast<uint8_t*>(temps.data()));
+                m_cursor += count;
+                if (m_cursor == total) {
+                    m_reader.Skip(m_directory.dataSize);
+                }
+            } else {
+                const size_t end = std::min(total, m_cursor + CELLS_PER_UNIT);
+                m_reader.ReadDoubles(temps.data() + m_cursor, end - m_cursor);
+                m_cursor = end;
+            }
+            setProgress(total == 0 ? 0.9 : 0.9 * static_cast<double>(m_cursor) / total);
+            if (m_cursor == total) {
+                m_phase = Phase::Genomes;
+                setPhase("Reading genomes");
+            }
+            return false;
+        }
+
+        case Phase::Genomes: {
+            if (m_formatVersion > INLINE_DNA_VERSION) {
+                save.genomes.Deserialize(m_reader);
+            }
+            const uint32_t count = m_reader.ReadUint32();
+            if (static_cast<size_t>(count) * CREATURE_FIXED_BYTES > m_reader.GetSize() - m_reader.GetPosition()) {
+                throw std::out_of_range("Creature count exceeds buffer size");
+            }
+            save.creatures.resize(count);
+            m_cursor = 0;
+            m_phase = Phase::Creatures;
+            setPhase("Reading creatures");
+            return false;
+        }
+
+        case Phase::Creatures: {
+            auto& creatures = save.creatures;
+            const size_t end = std::min(creatures.size(), m_cursor + CREATURES_PER_UNIT);
+            for (; m_cursor < end; ++m_cursor) {
+                if (m_formatVersion > INLINE_DNA_VERSION) {
+                    creatures[m_cursor].Deserialize(m_reader, save.genomes);
+                } else {
+                    creatures[m_cursor].DeserializeInlineDna(m_reader, save.genomes);
+                }
+            }
+            if (!creatures.empty()) {
+                setProgress(0.9 + 0.1 * static_cast<double>(m_cursor) / creatures.size());
+            }
+            if (m_cursor < creatures.size()) return false;
+            FlightRecorder::record(FlightRecorder::EventType::Load, "load.done", creatures.size());
+            return true;
+        }
+    }
+    return true;
+}
+
+} // namespace EvolutionSim
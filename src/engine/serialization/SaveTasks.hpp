@@ -0,0 +1,84 @@
+#pragma once
+
+#include "SaveSystem.hpp"
+#include "BlockCompression.hpp"
+#include "core/ResumableTask.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+class TemperatureSystem;
+
+namespace EvolutionSim {
+
+// Writes the same bytes as SaveSystem::SaveGame, a slice at a time. The
+// world is snapshotted when the task is created (a straight copy of the
+// grid), so the simulation can keep running while the bytes are encoded.
+// The temperature section is block-compressed, one block per worker each
+// slice.
+class SaveGameTask : public ResumableTask {
+public:
+    SaveGameTask(const std::string& saveName, const TemperatureSystem& tempSystem, double simulationTime);
+
+    // The encoded save; valid once the task is Done
+    const std::vector<uint8_t>& getResult() const { return m_result; }
+    std::vector<uint8_t> takeResult() { return std::move(m_result); }
+
+protected:
+    bool advance() override;
+
+private:
+    enum class Phase {
+        Header,
+        Temperatures,
+        Genomes,
+        Creatures,
+        Finish
+    };
+
+    Phase m_phase = Phase::Header;
+    GameSaveData m_snapshot;
+    size_t m_cursor = 0;
+    std::vector<BlockCompression::Block> m_blocks;
+    BinaryWriter m_writer;
+    std::vector<uint8_t> m_result;
+};
+
+// Parses a save produced by SaveGame / SaveGameTask a slice at a time.
+// The pointer constructor copies the input, so the caller's buffer may go
+// away after construction; the vector constructor takes the buffer over and
+// parses it in place. Version 1 saves (raw sections) still load.
+class LoadGameTask : public ResumableTask {
+public:
+    LoadGameTask(const uint8_t* data, size_t size);
+    explicit LoadGameTask(std::vector<uint8_t>&& data);
+
+    // The parsed save; valid once the task is Done
+    GameSaveData& getResult() { return *m_result; }
+    std::unique_ptr<GameSaveData> takeResult() { return std::move(m_result); }
+
+protected:
+    bool advance() override;
+
+private:
+    enum class Phase {
+        Header,
+        Temperatures,
+        Genomes,
+        Creatures
+    };
+
+    Phase m_phase = Phase::Header;
+    std::vector<uint8_t> m_data;
+    BinaryReader m_reader;
+    std::unique_ptr<GameSaveData> m_result;
+    size_t m_cursor = 0;
+    
+    // Format version from the file header; sections are block-compressed
+    // after RAW_SECTIONS_VERSION
+    uint16_t m_formatVersion = 0;
+    BlockCompression::Directory m_directory;
+    const uint8_t* m_sectionData = nullptr;
+};
+
+} // namespace EvolutionSim
@@ -136,6 +136,28 @@ void BinaryReader::ReadBytes(uint8_t* out, size_t size) {
     m_position += size;
 }
 
+void BinaryReader::ReadDoubles(double* out, size_t count) {
+    if (count > (m_size - m_position) / sizeof(double)) {
+        throw std::out_of_range("Read past end of buffer");
+    }
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Stored little-endian, same as memory: copy straight out of the buffer
+    std::memcpy(out, m_data + m_position, count * sizeof(double));
+    m_position += count * sizeof(double);
+#else
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = ReadDouble();
+    }
+#endif
+}
+
+void BinaryReader::Skip(size_t size) {
+    if (size > m_size - m_position) {
+        throw std::out_of_range("Read past end of buffer");
+    }
+    m_position += size;
+}
+
 void BinaryReader::ValidateMagic() {
     uint32_t magic = ReadUint32();
     if (magic != SERIALIZATION_MAGIC) {
@@ -4,12 +4,21 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
+#include <utility>
 
 namespace EvolutionSim {
     
     // Constants
     constexpr uint32_t SERIALIZATION_MAGIC = 0x45564F53; // 'EVOS' in hex
-    constexpr uint16_t CURRENT_VERSION = 1;
+    constexpr uint16_t CURRENT_VERSION = 3;
+    
+    // Version 2 stores large sections block-compressed (BlockCompression.hpp);
+    // version 1 saves, with raw sections, still load
+    constexpr uint16_t RAW_SECTIONS_VERSION = 1;
+    
+    // Version 3 moves creature DNA into a shared, delta-encoded genome table
+    // (genetics/GenomeStore.hpp); older saves store it inline per creature
+    constexpr uint16_t INLINE_DNA_VERSION = 2;
     
     // Forward declarations
     class BinaryWriter;
@@ -42,8 +51,12 @@ namespace EvolutionSim {
         void WriteString(const std::string& str);
         void WriteBytes(const uint8_t* data, size_t size);
         
+        // Grow capacity ahead of a large write
+        void Reserve(size_t size) { m_data.reserve(size); }
+        
         // Getters
         const std::vector<uint8_t>& GetData() const { return m_data; }
+        std::vector<uint8_t> TakeData() { return std::move(m_data); }
         size_t GetSize() const { return m_data.size(); }
         
     private:
@@ -69,13 +82,20 @@ namespace EvolutionSim {
         std::string ReadString();
         void ReadBytes(uint8_t* out, size_t size);
         
+        // Bulk read of `count` doubles; a single copy on little-endian hosts
+        void ReadDoubles(double* out, size_t count);
+        
         // Validation
         void ValidateMagic();
         void CheckVersion() const;
         
+        // Advance past `size` bytes read directly through GetCurrent()
+        void Skip(size_t size);
+        
         // Getters
         size_t GetPosition() const { return m_position; }
         size_t GetSize() const { return m_size; }
+        const uint8_t* GetCurrent() const { return m_data + m_position; }
         
     private:
         const uint8_t* m_data;
@@ -1,20 +1,105 @@
 #include <emscripten/bind.h>
 #include <emscripten/val.h>
 #include "TemperatureSystem.hpp"
+#include "core/FlightRecorder.hpp"
+#include "core/QualityGovernor.hpp"
+#include "memory/ExportArena.hpp"
+#include "SimulationTasks.hpp"
 #include "serialization/SaveSystem.hpp"
+#include "serialization/SaveTasks.hpp"
+#include <algorithm>
+#include <chrono>
+#include <limits>
 
 using namespace emscripten;
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Temperature colour ramp, matching temperatureRanges in
+// js/managers/TemperatureManager.js (alpha 0.9)
+struct ColourBand {
+    double max;
+    uint8_t r, g, b;
+};
+
+const ColourBand s_colourBands[] = {
+    {-100.0, 0, 0, 139},
+    {-50.0, 0, 0, 255},
+    {-20.0, 0, 191, 255},
+    {0.0, 173, 216, 230},
+    {20.0, 144, 238, 144},
+    {40.0, 255, 255, 0},
+    {60.0, 255, 165, 0},
+    {80.0, 255, 69, 0},
+    {100.0, 255, 0, 0},
+    {120.0, 178, 34, 34},
+    {1000.0, 128, 0, 0}
+};
+
+constexpr double MIN_COLOUR_TEMP = -273.15;
+
+uint32_t temperatureColour(double temp) {
+    if (temp >= MIN_COLOUR_TEMP) {
+        for (const ColourBand& band : s_colourBands) {
+            if (temp <= band.max) {
+                // Packed little-endian RGBA, so a Uint8Array view reads r, g, b, a
+                return band.r | (band.g << 8) | (band.b << 16) | (230u << 24);
+            }
+        }
+    }
+    return 128u << 24;  // Out of range: semi-transparent black
+}
+
+} // namespace
+
 // Wrapper class to expose TemperatureSystem to JavaScript
 class TemperatureSystemWrapper {
 public:
+    // Layout of the stats export buffer
+    enum Stat {
+        StatWidth,
+        StatHeight,
+        StatMin,
+        StatMax,
+        StatMean,
+        StatFrame,
+        StatQuality,   // Quality governor level, 0 = full
+        StatCount
+    };
+
     TemperatureSystemWrapper(uint32_t width, uint32_t height, double ambientTemp = 20.0)
-        : system(width, height, ambientTemp) {
+        : system(width, height, ambientTemp),
+          cells(static_cast<size_t>(width) * height),
+          arena(exportBytes(cells)) {
         system.initialize();
+
+        // Carved once; the addresses never change for the life of the wrapper
+        exportTemperatures = arena.allocate<float>(cells, "temperature");
+        exportColours = arena.allocate<uint32_t>(cells, "colour");
+        exportStats = arena.allocate<double>(StatCount, "stats");
+        std::fill(exportStats, exportStats + StatCount, 0.0);
+        scratch.resize(cells);
     }
     
+    // Ticks are folded into coarse passes while the governor asks for
+    // substeps, so the simulation keeps its pace at a lower cost
     void update(uint64_t deltaTime) {
-        system.update(deltaTime);
+        const auto start = Clock::now();
+        pendingTicks += 1;
+        pendingTime += deltaTime;
+        const uint32_t substeps = governor.getLevel().substeps;
+        if (pendingTicks >= substeps) {
+            system.updateCoarse(pendingTime, pendingTicks);
+            pendingTicks = 0;
+            pendingTime = 0;
+        }
+        governor.addCost(QualityGovernor::Stage::Tick, millisecondsSince(start));
     }
     
     double getTemperature(uint32_t x, uint32_t y) const {
@@ -22,6 +107,8 @@ public:
     }
     
     void setTemperature(uint32_t x, uint32_t y, double temp) {
+        FlightRecorder::record(FlightRecorder::EventType::Command, "setTemperature",
+                               static_cast<uint64_t>(x) << 32 | y, temp);
         system.setTemperature(x, y, temp);
     }
     
@@ -29,26 +116,164 @@ public:
     // Format: [width, height, t0, t1, t2, ...]
     std::vector<double> getTemperatureData() const {
         const auto& grid = system.getGrid();
-        std::vector<double> result;
-        result.reserve(2 + grid.width * grid.height);
-        
-        result.push_back(static_cast<double>(grid.width));
-        result.push_back(static_cast<double>(grid.height));
-        
-        for (const auto& row : grid.cells) {
-            for (const auto& cell : row) {
-                result.push_back(cell.temperature);
-            }
-        }
+        std::vector<double> result(2 + static_cast<size_t>(grid.width) * grid.height);
+
+        result[0] = static_cast<double>(grid.width);
+        result[1] = static_cast<double>(grid.height);
+
+        // Row-major regardless of the engine's storage layout
+        system.copyTemperatures(result.data() + 2);
         
         return result;
     }
     
+    // Refresh the export buffers from the current grid. JS keeps views over
+    // them (see js/utils/ExportViews.js) and only rewraps when
+    // getGrowthEpoch() changes. Called once per rendered frame, so it also
+    // closes the frame for the quality governor; the overlay resolution and
+    // stats rate follow the governor's level.
+    void exportFrame() {
+        const auto start = Clock::now();
+        const QualityGovernor::Level& level = governor.getLevel();
+        system.copyTemperatures(scratch.data());
+        for (size_t i = 0; i < cells; ++i) {
+            exportTemperatures[i] = static_cast<float>(scratch[i]);
+        }
+        exportOverlay(level.overlayStride);
+        if (framesSinceStats == 0) {
+            exportStatistics();
+        }
+        framesSinceStats = (framesSinceStats + 1) % level.statsInterval;
+        exportStats[StatFrame] += 1.0;
+
+        governor.addCost(QualityGovernor::Stage::Export, millisecondsSince(start));
+        governor.endFrame();
+        exportStats[StatQuality] = static_cast<double>(governor.getLevelIndex());
+    }
+
+    // Quality governor state: {level, levelCount, overlayStride,
+    // statsInterval, substeps, agentLod, averageMs, budgetMs}
+    val getQuality() const {
+        const QualityGovernor::Level& level = governor.getLevel();
+        val quality = val::object();
+        quality.set("level", static_cast<uint32_t>(governor.getLevelIndex()));
+        quality.set("levelCount", static_cast<uint32_t>(governor.getLevelCount()));
+        quality.set("overlayStride", level.overlayStride);
+        quality.set("statsInterval", level.statsInterval);
+        quality.set("substeps", level.substeps);
+        quality.set("agentLod", level.agentLod);
+        quality.set("averageMs", governor.getAverageCost());
+        quality.set("budgetMs", governor.getSettings().budgetMs);
+        return quality;
+    }
+
+    void setFrameBudget(double milliseconds) { governor.setBudget(milliseconds); }
+
+    // Fixed quality level (e.g. from settings), or -1 to let the governor adapt
+    void setQualityLevel(int level) {
+        governor.setEnabled(level < 0);
+        if (level >= 0) governor.setLevel(static_cast<size_t>(level));
+    }
+
+    // Views over the export arena (Float32Array, Uint8Array of RGBA, Float64Array)
+    val getTemperatureView() const { return val(typed_memory_view(cells, exportTemperatures)); }
+    val getColourView() const {
+        return val(typed_memory_view(cells * 4, reinterpret_cast<const uint8_t*>(exportColours)));
+    }
+    val getStatsView() const { return val(typed_memory_view(static_cast<size_t>(StatCount), exportStats)); }
+
+    static uint32_t getGrowthEpoch() { return ExportArena::growthEpoch(); }
+
+    const TemperatureSystem& getSystem() const { return system; }
+    TemperatureSystem& getSystem() { return system; }
+    
+    // Time-sliced operations; JS drives them with step() (js/utils/TaskRunner.js)
+    InitializeTask* createInitializeTask() { return new InitializeTask(system); }
+    FastForwardTask* createFastForwardTask(double ticks) {
+        return new FastForwardTask(system, static_cast<uint64_t>(std::max(0.0, ticks)));
+    }
+    
 private:
+    // Colour one cell per stride x stride block and fill the block with it
+    void exportOverlay(uint32_t stride) {
+        const auto& grid = system.getGrid();
+        if (stride <= 1) {
+            for (size_t i = 0; i < cells; ++i) {
+                exportColours[i] = temperatureColour(scratch[i]);
+            }
+            return;
+        }
+        for (uint32_t by = 0; by < grid.height; by += stride) {
+            const uint32_t yEnd = std::min(grid.height, by + stride);
+            for (uint32_t bx = 0; bx < grid.width; bx += stride) {
+                const uint32_t xEnd = std::min(grid.width, bx + stride);
+                const uint32_t colour = temperatureColour(scratch[static_cast<size_t>(by) * grid.width + bx]);
+                for (uint32_t y = by; y < yEnd; ++y) {
+                    uint32_t* row = exportColours + static_cast<size_t>(y) * grid.width;
+                    std::fill(row + bx, row + xEnd, colour);
+                }
+            }
+        }
+    }
+
+    void exportStatistics() {
+        double minTemp = std::numeric_limits<double>::max();
+        double maxTemp = std::numeric_limits<double>::lowest();
+        double sum = 0.0;
+        for (size_t i = 0; i < cells; ++i) {
+            const double t = scratch[i];
+            minTemp = std::min(minTemp, t);
+            maxTemp = std::max(maxTemp, t);
+            sum += t;
+        }
+
+        const auto& grid = system.getGrid();
+        exportStats[StatWidth] = grid.width;
+        exportStats[StatHeight] = grid.height;
+        exportStats[StatMin] = cells ? minTemp : 0.0;
+        exportStats[StatMax] = cells ? maxTemp : 0.0;
+        exportStats[StatMean] = cells ? sum / static_cast<double>(cells) : 0.0;
+    }
+
+    static size_t exportBytes(size_t cells) {
+        // Each buffer plus cache-line alignment slack
+        return cells * (sizeof(float) + sizeof(uint32_t)) + StatCount * sizeof(double) + 3 * 64;
+    }
+
     TemperatureSystem system;
+    size_t cells;
+    ExportArena arena;
+    float* exportTemperatures = nullptr;
+    uint32_t* exportColours = nullptr;
+    double* exportStats = nullptr;
+    std::vector<double> scratch;
+    QualityGovernor governor;
+    uint32_t framesSinceStats = 0;
+    uint32_t pendingTicks = 0;     // Ticks waiting for the next coarse pass
+    uint64_t pendingTime = 0;
 };
 
 // Binding code
+// Task status as a plain int for JS: 0 running, 1 done, 2 failed
+int stepTask(ResumableTask& task, uint32_t budgetMicros) {
+    return static_cast<int>(task.step(budgetMicros));
+}
+
+int getTaskStatus(const ResumableTask& task) {
+    return static_cast<int>(task.getStatus());
+}
+
+emscripten::val getSaveTaskResult(const EvolutionSim::SaveGameTask& task) {
+    const auto& data = task.getResult();
+    emscripten::val jsArray = emscripten::val::global("Uint8Array").new_(data.size());
+    jsArray.call<void>("set", emscripten::val(emscripten::typed_memory_view(data.size(), data.data())));
+    return jsArray;
+}
+
+std::string getLoadTaskSaveName(EvolutionSim::LoadGameTask& task) {
+    return task.getResult().saveName;
+}
+
 // Wrapper for SaveSystem
 class SaveSystemWrapper {
 public:
@@ -68,42 +293,115 @@ public:
         return jsArray;
     }
     
-    std::string loadGame(const emscripten::val& jsData) {
-        // Convert JS Uint8Array to std::vector<uint8_t>
-        size_t length = jsData["length"].as<size_t>();
-        std::vector<uint8_t> data(length);
-        
-        emscripten::val memoryView = emscripten::val(emscripten::typed_memory_view(
-            length, data.data()
-        ));
-        memoryView.call<void>("set", jsData);
-        
-        // For now, just return the save name
+    // Engine-owned buffer JS writes a save into, e.g. chunk by chunk from a
+    // fetch or IndexedDB stream. Returns a Uint8Array view over it; fill it
+    // right away, since any allocation may grow the heap and detach the view.
+    emscripten::val getLoadBuffer(size_t size) {
+        loadBuffer.resize(size);
+        return emscripten::val(emscripten::typed_memory_view(loadBuffer.size(), loadBuffer.data()));
+    }
+    
+    // Parse the first `size` bytes of the load buffer in place. The buffer is
+    // handed to the loader, so getLoadBuffer() must be called again for the
+    // next load.
+    std::string loadFromBuffer(size_t size) {
+        loadBuffer.resize(std::min(size, loadBuffer.size()));
         try {
             EvolutionSim::SaveSystem saveSystem;
-            auto saveData = saveSystem.LoadGame(data.data(), data.size());
+            auto saveData = saveSystem.LoadGame(std::move(loadBuffer));
+            loadBuffer.clear();
             return saveData->saveName;
         } catch (const std::exception& e) {
+            loadBuffer.clear();
             emscripten::val::global("console").call<void>("error", std::string("Load failed: ") + e.what());
             throw;
         }
     }
+    
+    std::string loadGame(const emscripten::val& jsData) {
+        // One bulk copy from the JS array into the load buffer, then parse in place
+        const size_t length = jsData["length"].as<size_t>();
+        getLoadBuffer(length).call<void>("set", jsData);
+        return loadFromBuffer(length);
+    }
+    
+    // Sliced variants of saveGame / loadGame; the caller owns the task
+    EvolutionSim::SaveGameTask* createSaveTask(const std::string& name, const TemperatureSystemWrapper& tempSystem, double simTime) {
+        return new EvolutionSim::SaveGameTask(name, tempSystem.getSystem(), simTime);
+    }
+    
+    EvolutionSim::LoadGameTask* createLoadTask(const emscripten::val& jsData) {
+        const size_t length = jsData["length"].as<size_t>();
+        getLoadBuffer(length).call<void>("set", jsData);
+        return createLoadTaskFromBuffer(length);
+    }
+    
+    EvolutionSim::LoadGameTask* createLoadTaskFromBuffer(size_t size) {
+        loadBuffer.resize(std::min(size, loadBuffer.size()));
+        auto* task = new EvolutionSim::LoadGameTask(std::move(loadBuffer));
+        loadBuffer.clear();
+        return task;
+    }
+    
+private:
+    std::vector<uint8_t> loadBuffer;
 };
 
+std::string dumpFlightRecorder(const std::string& reason) {
+    return FlightRecorder::dumpText(reason.c_str());
+}
+
+// Plain export for the JS abort hook: embind may be unusable once the
+// module has aborted, and this allocates nothing
+extern "C" EMSCRIPTEN_KEEPALIVE const char* flight_recorder_dump() {
+    return FlightRecorder::dumpText("abort");
+}
+
 EMSCRIPTEN_BINDINGS(evolution_sim) {
+    function("dumpFlightRecorder", &dumpFlightRecorder);
+
     // Temperature System
     class_<TemperatureSystemWrapper>("TemperatureSystem")
         .constructor<uint32_t, uint32_t, double>()
         .function("update", &TemperatureSystemWrapper::update)
         .function("getTemperature", &TemperatureSystemWrapper::getTemperature)
         .function("setTemperature", &TemperatureSystemWrapper::setTemperature)
-        .function("getTemperatureData", &TemperatureSystemWrapper::getTemperatureData);
+        .function("getTemperatureData", &TemperatureSystemWrapper::getTemperatureData)
+        .function("exportFrame", &TemperatureSystemWrapper::exportFrame)
+        .function("getTemperatureView", &TemperatureSystemWrapper::getTemperatureView)
+        .function("getColourView", &TemperatureSystemWrapper::getColourView)
+        .function("getStatsView", &TemperatureSystemWrapper::getStatsView)
+        .function("getQuality", &TemperatureSystemWrapper::getQuality)
+        .function("setFrameBudget", &TemperatureSystemWrapper::setFrameBudget)
+        .function("setQualityLevel", &TemperatureSystemWrapper::setQualityLevel)
+        .class_function("getGrowthEpoch", &TemperatureSystemWrapper::getGrowthEpoch)
+        .function("createInitializeTask", &TemperatureSystemWrapper::createInitializeTask, allow_raw_pointers())
+        .function("createFastForwardTask", &TemperatureSystemWrapper::createFastForwardTask, allow_raw_pointers());
+        
+    // Resumable tasks
+    class_<ResumableTask>("ResumableTask")
+        .function("step", &stepTask)
+        .function("getStatus", &getTaskStatus)
+        .function("getProgress", &ResumableTask::getProgress)
+        .function("getPhase", &ResumableTask::getPhase)
+        .function("getError", &ResumableTask::getError);
+    class_<InitializeTask, base<ResumableTask>>("InitializeTask");
+    class_<FastForwardTask, base<ResumableTask>>("FastForwardTask");
+    class_<EvolutionSim::SaveGameTask, base<ResumableTask>>("SaveGameTask")
+        .function("getResult", &getSaveTaskResult);
+    class_<EvolutionSim::LoadGameTask, base<ResumableTask>>("LoadGameTask")
+        .function("getSaveName", &getLoadTaskSaveName);
         
     // Save System
     class_<SaveSystemWrapper>("SaveSystem")
         .constructor<>()
         .function("saveGame", &SaveSystemWrapper::saveGame)
-        .function("loadGame", &SaveSystemWrapper::loadGame);
+        .function("loadGame", &SaveSystemWrapper::loadGame)
+        .function("getLoadBuffer", &SaveSystemWrapper::getLoadBuffer)
+        .function("loadFromBuffer", &SaveSystemWrapper::loadFromBuffer)
+        .function("createSaveTask", &SaveSystemWrapper::createSaveTask, allow_raw_pointers())
+        .function("createLoadTask", &SaveSystemWrapper::createLoadTask, allow_raw_pointers())
+        .function("createLoadTaskFromBuffer", &SaveSystemWrapper::createLoadTaskFromBuffer, allow_raw_pointers());
 }
 
 // This function is called when the WebAssembly module is instantiated
@@ -0,0 +1,46 @@
+#include "MaterialGrid.hpp"
+#include <algorithm>
+
+namespace {
+
+const MaterialProperties s_materials[static_cast<size_t>(Material::Count)] = {
+    // name     transparency  emissivity
+    {"air",     1.0f,         0.0f},
+    {"water",   0.6f,         0.95f},
+    {"stone",   0.0f,         0.9f},
+    {"edge",    0.0f,         0.0f}
+};
+
+} // namespace
+
+MaterialGrid::MaterialGrid(uint32_t width, uint32_t height, Material fill)
+    : m_width(width), m_height(height),
+      m_cells(static_cast<size_t>(width) * height, static_cast<uint8_t>(fill)),
+      m_columnRevision(width, 0) {}
+
+const MaterialProperties& MaterialGrid::properties(Material material) {
+    const size_t id = std::min(static_cast<size_t>(material), static_cast<size_t>(Material::Count) - 1);
+    return s_materials[id];
+}
+
+void MaterialGrid::set(uint32_t x, uint32_t y, Material material) {
+    if (x >= m_width || y >= m_height) return;
+    m_cells[static_cast<size_t>(y) * m_width + x] = static_cast<uint8_t>(material);
+    m_columnRevision[x] = ++m_revision;
+}
+
+void MaterialGrid::fillRect(uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, Material material) {
+    if (x0 >= m_width || y0 >= m_height || w == 0 || h == 0) return;
+    // Clamp by the room left rather than by x0 + w, which can wrap
+    const uint32_t x1 = x0 + std::min(w, m_width - x0);
+    const uint32_t y1 = y0 + std::min(h, m_height - y0);
+    for (uint32_t y = y0; y < y1; ++y) {
+        std::fill(m_cells.begin() + static_cast<size_t>(y) * m_width + x0,
+                  m_cells.begin() + static_cast<size_t>(y) * m_width + x1,
+                  static_cast<uint8_t>(material));
+    }
+    ++m_revision;
+    for (uint32_t x = x0; x < x1; ++x) {
+        m_columnRevision[x] = m_revision;
+    }
+}
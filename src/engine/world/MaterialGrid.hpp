@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Material ids, matching TILE_TYPES in js/managers/TileManager.js
+enum class Material : uint8_t {
+    Air,
+    Water,
+    Stone,
+    Edge,
+    Count
+};
+
+// Per-material constants the engine needs. Visual properties stay in JS.
+struct MaterialProperties {
+    const char* name;
+    float transparency;  // Fraction of radiation / light passing through one cell (0-1)
+    float emissivity;    // Thermal emissivity, also absorptivity (0-1)
+};
+
+// Material id per cell, row-major. Tracks a revision counter so dependent
+// caches (radiation visibility, illumination) know when to rebuild.
+class MaterialGrid {
+public:
+    MaterialGrid(uint32_t width, uint32_t height, Material fill = Material::Air);
+
+    static const MaterialProperties& properties(Material material);
+
+    uint32_t getWidth() const { return m_width; }
+    uint32_t getHeight() const { return m_height; }
+
+    Material get(uint32_t x, uint32_t y) const {
+        return static_cast<Material>(m_cells[static_cast<size_t>(y) * m_width + x]);
+    }
+    void set(uint32_t x, uint32_t y, Material material);
+    void fillRect(uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, Material material);
+
+    // Raw ids, row-major; one byte per cell
+    const uint8_t* data() const { return m_cells.data(); }
+
+    // Bumped on every change
+    uint64_t getRevision() const { return m_revision; }
+
+    // Revision of the last change in column x. A cache built at revision r
+    // only needs to redo columns whose revision is greater than r.
+    uint64_t getColumnRevision(uint32_t x) const { return m_columnRevision[x]; }
+
+private:
+    uint32_t m_width;
+    uint32_t m_height;
+    std::vector<uint8_t> m_cells;
+    std::vector<uint64_t> m_columnRevision;
+    uint64_t m_revision = 0;
+};
@@ -0,0 +1,190 @@
+#include "RayCaster.hpp"
+#include "TemperatureSystem.hpp"
+#include "core/JobSystem.hpp"
+#include "field/GridLayout.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Rays per job; rays are short, so batches need to be fairly large
+constexpr size_t RAY_GRAIN = 1024;
+
+// Opacity by material id, indexed by the raw cell byte
+struct OpacityTable {
+    bool opaque[256];
+
+    OpacityTable() {
+        for (size_t id = 0; id < 256; ++id) {
+            opaque[id] = MaterialGrid::properties(static_cast<Material>(id)).transparency <= 0.0f;
+        }
+    }
+};
+
+const OpacityTable& opacity() {
+    static const OpacityTable s_table;
+    return s_table;
+}
+
+float temperatureAt(const TemperatureSystem* temperatures, uint32_t x, uint32_t y) {
+    if (!temperatures) return 0.0f;
+    // Coordinates come from the material grid; a temperature grid of a
+    // different size must not be indexed past its edge
+    const TemperatureSystem::Grid& grid = temperatures->getGrid();
+    if (x >= grid.width || y >= grid.height) return 0.0f;
+    return static_cast<float>(grid.temperature[grid.index(x, y)]);
+}
+
+} // namespace
+
+void RayCaster::Hits::resize(size_t count) {
+    distance.resize(count);
+    material.resize(count);
+    temperature.resize(count);
+}
+
+uint32_t RayCaster::castOne(const MaterialGrid& materials, const TemperatureSystem* temperatures,
+                            const Ray& ray, float& distance, Material& material, float& temperature) {
+    const uint32_t width = materials.getWidth();
+    const uint32_t height = materials.getHeight();
+    const float maxDistance = std::max(ray.maxDistance, 0.0f);
+
+    // Origins off the map (or NaN) see the edge straight away
+    if (!(ray.originX >= 0.0f && ray.originY >= 0.0f &&
+          ray.originX < static_cast<float>(width) && ray.originY < static_cast<float>(height))) {
+        distance = 0.0f;
+        material = Material::Edge;
+        temperature = 0.0f;
+        return 0;
+    }
+
+    const bool* opaque = opacity().opaque;
+    const uint8_t* cells = materials.data();
+    int64_t x = static_cast<int64_t>(ray.originX);
+    int64_t y = static_cast<int64_t>(ray.originY);
+    size_t index = static_cast<size_t>(y) * width + static_cast<size_t>(x);
+    uint32_t visited = 1;
+
+    const float length = std::sqrt(ray.dirX * ray.dirX + ray.dirY * ray.dirY);
+    if (opaque[cells[index]] || !(length > 0.0f)) {
+        const bool hit = opaque[cells[index]];
+        distance = hit ? 0.0f : maxDistance;
+        material = hit ? static_cast<Material>(cells[index]) : NO_HIT;
+        temperature = temperatureAt(temperatures, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+        return visited;
+    }
+
+    // Distance along the ray to the next vertical / horizontal cell
+    // boundary, and between successive ones
+    constexpr float INF = std::numeric_limits<float>::infinity();
+    const float dx = ray.dirX / length;
+    const float dy = ray.dirY / length;
+    const int64_t stepX = dx > 0.0f ? 1 : -1;
+    const int64_t stepY = dy > 0.0f ? 1 : -1;
+    const ptrdiff_t strideY = dy > 0.0f ? static_cast<ptrdiff_t>(width) : -static_cast<ptrdiff_t>(width);
+    const float deltaX = dx != 0.0f ? 1.0f / std::fabs(dx) : INF;
+    const float deltaY = dy != 0.0f ? 1.0f / std::fabs(dy) : INF;
+    float nextX = dx == 0.0f ? INF : (dx > 0.0f ? (x + 1 - ray.originX) : (ray.originX - x)) * deltaX;
+    float nextY = dy == 0.0f ? INF : (dy > 0.0f ? (y + 1 - ray.originY) : (ray.originY - y)) * deltaY;
+
+    // Branch-free step: which axis to cross is close to random, so a
+    // branch on it would mispredict about half the time
+    for (;;) {
+        const bool alongX = nextX < nextY;
+        const float t = alongX ? nextX : nextY;
+        if (t > maxDistance) break;
+        const int64_t prevX = x;
+        const int64_t prevY = y;
+        x += alongX ? stepX : 0;
+        y += alongX ? 0 : stepY;
+        nextX += alongX ? deltaX : 0.0f;
+        nextY += alongX ? 0.0f : deltaY;
+        if ((static_cast<uint64_t>(x) >= width) | (static_cast<uint64_t>(y) >= height)) {
+            distance = t;
+            material = Material::Edge;
+            temperature = temperatureAt(temperatures, static_cast<uint32_t>(prevX), static_cast<uint32_t>(prevY));
+            return visited;
+        }
+        index += alongX ? stepX : strideY;
+        ++visited;
+        if (opaque[cells[index]]) {
+            distance = t;
+            material = static_cast<Material>(cells[index]);
+            temperature = temperatureAt(temperatures, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+            return visited;
+        }
+    }
+
+    distance = maxDistance;
+    material = NO_HIT;
+    temperature = temperatureAt(temperatures, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+    return visited;
+}
+
+uint64_t RayCaster::cast(const MaterialGrid& materials, const TemperatureSystem* temperatures,
+                         const Ray* rays, size_t count, Hits& hits) {
+    hits.resize(count);
+    if (count == 0) return 0;
+
+    // An empty grid has no chunks to sort into; nothing can be hit
+    if (materials.getWidth() == 0 || materials.getHeight() == 0) {
+        for (size_t i = 0; i < count; ++i) {
+            hits.distance[i] = std::max(rays[i].maxDistance, 0.0f);
+            hits.material[i] = NO_HIT;
+            hits.temperature[i] = 0.0f;
+        }
+        return 0;
+    }
+
+    // Counting sort of rays by the chunk holding their origin; origins off
+    // the map go to the nearest chunk
+    const uint32_t chunksX = (materials.getWidth() + GridLayout::TILE_MASK) >> GridLayout::TILE_SHIFT;
+    const uint32_t chunksY = (materials.getHeight() + GridLayout::TILE_MASK) >> GridLayout::TILE_SHIFT;
+    auto chunkOf = [&](const Ray& ray) {
+        const float maxX = static_cast<float>(chunksX - 1);
+        const float maxY = static_cast<float>(chunksY - 1);
+        const float cx = std::clamp(std::floor(ray.originX / GridLayout::TILE_SIZE), 0.0f, maxX);
+        const float cy = std::clamp(std::floor(ray.originY / GridLayout::TILE_SIZE), 0.0f, maxY);
+        // NaN survives the clamp; send it to chunk 0
+        return cx == cx && cy == cy
+            ? static_cast<uint32_t>(cy) * chunksX + static_cast<uint32_t>(cx) : 0u;
+    };
+
+    m_chunks.resize(count);
+    m_offsets.assign(static_cast<size_t>(chunksX) * chunksY + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        m_chunks[i] = chunkOf(rays[i]);
+        ++m_offsets[m_chunks[i] + 1];
+    }
+    for (size_t c = 1; c < m_offsets.size(); ++c) {
+        m_offsets[c] += m_offsets[c - 1];
+    }
+    // Copy the rays themselves, not just their indices: the casting pass
+    // then streams through them instead of gathering from the input
+    m_sorted.resize(count);
+    m_order.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t slot = m_offsets[m_chunks[i]]++;
+        m_sorted[slot] = rays[i];
+        m_order[slot] = static_cast<uint32_t>(i);
+    }
+
+    auto& jobs = JobSystem::get();
+    m_visited.assign(jobs.getWorkerCount(), 0);
+    jobs.parallelFor(count, [&](size_t begin, size_t end, unsigned worker) {
+        uint64_t visited = 0;
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t i = m_order[k];
+            visited += castOne(materials, temperatures, m_sorted[k],
+                               hits.distance[i], hits.material[i], hits.temperature[i]);
+        }
+        m_visited[worker] += visited;
+    }, RAY_GRAIN);
+
+    uint64_t total = 0;
+    for (uint64_t visited : m_visited) {
+        total += visited;
+    }
+    return total;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "MaterialGrid.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TemperatureSystem;
+
+// Batched grid ray casting for creature vision.
+//
+// Each ray walks the material grid cell by cell (Amanatides-Woo DDA) from
+// its origin until it enters an opaque cell (transparency 0), leaves the
+// map or runs out of range. Rays from all creatures go in one batch: they
+// are counting-sorted by the 32x32 chunk their origin lies in, so rays cast
+// from the same area walk the same cache lines one after another, and the
+// sorted list is split across the job system.
+//
+// Results come back in input order as separate arrays (distance, material,
+// temperature), so a sensor that only needs one of them reads one stream.
+// Not thread-safe apart from cast()'s internal workers.
+class RayCaster {
+public:
+    struct Ray {
+        float originX;       // Cells; the cell under the origin is tested first
+        float originY;
+        float dirX;          // Need not be normalized
+        float dirY;
+        float maxDistance;   // Cells
+    };
+
+    // Material::Count marks a miss: nothing opaque within maxDistance.
+    // Leaving the map is a hit on Material::Edge where the ray crosses it.
+    static constexpr Material NO_HIT = Material::Count;
+
+    struct Hits {
+        std::vector<float> distance;      // Along the ray, in cells; maxDistance on a miss
+        std::vector<Material> material;   // Material hit, or NO_HIT
+        std::vector<float> temperature;   // Celsius at the hit cell, or at the last cell
+                                          // passed through on a miss or at the edge
+
+        size_t size() const { return distance.size(); }
+        void resize(size_t count);
+    };
+
+    // Cast `count` rays. `temperatures` may be null, leaving temperature at 0;
+    // it should match the material grid's size (cells outside it read 0).
+    // On an empty grid every ray misses.
+    // Returns the number of cells visited, for profiling.
+    uint64_t cast(const MaterialGrid& materials, const TemperatureSystem* temperatures,
+                  const Ray* rays, size_t count, Hits& hits);
+
+    // Cast one ray without sorting or threading (sensor probes, debugging)
+    static uint32_t castOne(const MaterialGrid& materials, const TemperatureSystem* temperatures,
+                            const Ray& ray, float& distance, Material& material, float& temperature);
+
+private:
+    // Scratch
+    std::vector<uint32_t> m_chunks;    // Origin chunk per input ray
+    std::vector<Ray> m_sorted;         // Rays in chunk order
+    std::vector<uint32_t> m_order;     // Input index of each sorted ray
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint64_t> m_visited;   // Per worker
+};
@@ -47,6 +47,22 @@ class Engine {
             setPosition(x, y) {
                 this.x = this.targetX = x;
                 this.y = this.targetY = y;
+            },
+            /**
+             * Visible area in map cells, for the engine's distance-based
+             * agent update LOD (AgentLodScheduler::setViewport)
+             * @param {number} cellSize - Cell size in pixels
+             * @param {number} width - Viewport width in pixels
+             * @param {number} height - Viewport height in pixels
+             * @returns {{minX: number, minY: number, maxX: number, maxY: number}}
+             */
+            visibleCells(cellSize, width, height) {
+                return {
+                    minX: this.x / cellSize,
+                    minY: this.y / cellSize,
+                    maxX: (this.x + width) / cellSize,
+                    maxY: (this.y + height) / cellSize
+                };
             }
         };
         
@@ -1,6 +1,7 @@
 import { logger } from '../utils/logger.js';
 import { eventBus } from '../core/EventBus.js';
 import { config } from '../core/Config.js';
+import { taskRunner } from '../utils/TaskRunner.js';
 
 // Constants
 const SAVE_VERSION = '2.0.0';
@@ -476,11 +477,20 @@ class SaveManager {
                         }
                     }
 
-                    const binaryData = this.saveSystem.saveGame(
-                        saveName,
-                        tempSystem,
-                        gameState.simulationTime || 0
-                    );
+                    // Time-sliced save when the engine provides it, so large
+                    // worlds encode across frames instead of blocking input
+                    const binaryData = this.saveSystem.createSaveTask
+                        ? await taskRunner.run(
+                            this.saveSystem.createSaveTask(saveName, tempSystem, gameState.simulationTime || 0),
+                            {
+                                onProgress: (percent, phase) => onProgress?.(10 + Math.round(percent * 0.75), `${phase}...`),
+                                onDone: (task) => task.getResult()
+                            })
+                        : this.saveSystem.saveGame(
+                            saveName,
+                            tempSystem,
+                            gameState.simulationTime || 0
+                        );
 
                     saveData = {
                         id: saveId || `save_${Date.now()}`,
@@ -571,8 +581,19 @@ class SaveManager {
 
                     if (!save.binaryData) throw new Error('Invalid save format: missing binary data');
 
-                    const binaryData = new Uint8Array(save.binaryData);
-                    const saveName = this.saveSystem.loadGame(binaryData);
+                    let saveName;
+                    if (this.saveSystem.getLoadBuffer && this.saveSystem.createLoadTaskFromBuffer) {
+                        // Write the bytes straight into the engine's load buffer
+                        // (one copy) and let it parse them in place
+                        const length = save.binaryData.length;
+                        this.saveSystem.getLoadBuffer(length).set(save.binaryData);
+                        saveName = await taskRunner.run(this.saveSystem.createLoadTaskFromBuffer(length), {
+                            onProgress: (percent, phase) => onProgress?.(10 + Math.round(percent * 0.85), `${phase}...`),
+                            onDone: (task) => task.getSaveName()
+                        });
+                    } else {
+                        saveName = this.saveSystem.loadGame(new Uint8Array(save.binaryData));
+                    }
 
                     onProgress?.(100, 'Game loaded successfully!');
 
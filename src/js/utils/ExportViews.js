@@ -0,0 +1,51 @@
+/**
+ * Cached typed-array views over a WASM TemperatureSystem's export arena.
+ *
+ * The engine carves its export buffers once, so their addresses never change;
+ * a view only goes stale when the WASM heap grows and detaches the old
+ * ArrayBuffer. Instead of wrapping the buffers every frame, check the
+ * engine's growth epoch (one integer) and rewrap only when it moves.
+ *
+ * Usage, once per frame:
+ *   system.exportFrame();
+ *   const { temperatures, colours, stats } = views.get();
+ */
+export class ExportViews {
+  /**
+   * @param {Object} TemperatureSystem - The bound TemperatureSystem class (for getGrowthEpoch)
+   * @param {Object} system - A TemperatureSystem instance
+   */
+  constructor(TemperatureSystem, system) {
+    this.TemperatureSystem = TemperatureSystem;
+    this.system = system;
+    this.epoch = -1;
+    this.views = null;
+  }
+
+  /**
+   * Current views, rewrapped only after a heap growth
+   * @returns {{temperatures: Float32Array, colours: Uint8Array, stats: Float64Array}}
+   */
+  get() {
+    const epoch = this.TemperatureSystem.getGrowthEpoch();
+    // A detached view reports length 0; rewrap in that case too, in case the
+    // heap grew since the engine last sampled its size
+    if (epoch !== this.epoch || !this.views || this.views.stats.length === 0) {
+      this.views = {
+        temperatures: this.system.getTemperatureView(),
+        colours: this.system.getColourView(),
+        stats: this.system.getStatsView()
+      };
+      this.epoch = epoch;
+    }
+    return this.views;
+  }
+
+  /**
+   * Drop the cached views (call before deleting the system)
+   */
+  release() {
+    this.views = null;
+    this.system = null;
+  }
+}
@@ -0,0 +1,66 @@
+import { logger } from './logger.js';
+
+// Matches ResumableTask::Status in src/engine/core/ResumableTask.hpp
+const TASK_RUNNING = 0;
+const TASK_DONE = 1;
+
+/**
+ * Drives engine ResumableTasks (saves, loads, initialization, fast-forward)
+ * a slice per animation frame, so long operations never block input.
+ */
+export class TaskRunner {
+  /**
+   * @param {Object} [options]
+   * @param {number} [options.budgetMs=6] - Engine time per frame given to the task
+   */
+  constructor(options = {}) {
+    this.budgetMs = options.budgetMs ?? 6;
+  }
+
+  /**
+   * Step `task` once per frame until it finishes. The task is deleted
+   * afterwards unless `keep` is set (e.g. to read its result first).
+   * @param {Object} task - A bound ResumableTask
+   * @param {Object} [options]
+   * @param {Function} [options.onProgress] - Called with (percent, phase) after each frame
+   * @param {Function} [options.onDone] - Called with the task before it is deleted
+   * @returns {Promise<*>} Resolves with onDone's return value
+   */
+  run(task, { onProgress, onDone } = {}) {
+    const budgetMicros = Math.max(0, Math.round(this.budgetMs * 1000));
+
+    return new Promise((resolve, reject) => {
+      const frame = () => {
+        let status;
+        try {
+          status = task.step(budgetMicros);
+          onProgress?.(Math.round(task.getProgress() * 100), task.getPhase());
+        } catch (error) {
+          task.delete();
+          reject(error);
+          return;
+        }
+
+        if (status === TASK_RUNNING) {
+          requestAnimationFrame(frame);
+          return;
+        }
+
+        try {
+          if (status === TASK_DONE) {
+            resolve(onDone ? onDone(task) : undefined);
+          } else {
+            const message = task.getError() || 'Task failed';
+            logger.error(`Task failed: ${message}`);
+            reject(new Error(message));
+          }
+        } finally {
+          task.delete();
+        }
+      };
+      requestAnimationFrame(frame);
+    });
+  }
+}
+
+export const taskRunner = new TaskRunner();
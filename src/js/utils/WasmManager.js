@@ -22,6 +22,7 @@ export class WasmManager {
     this.init = this.init.bind(this);
     this.loadModule = this.loadModule.bind(this);
     this.readString = this.readString.bind(this);
+    this.dumpFlightRecorder = this.dumpFlightRecorder.bind(this);
     this.cleanup = this.cleanup.bind(this);
   }
 
@@ -48,6 +49,20 @@ export class WasmManager {
     return this.textDecoder.decode(memoryBytes.subarray(ptr, ptr + len));
   }
 
+  /**
+   * Log the engine's flight recorder (its most recent events) to the console
+   * @param {string} reason - What triggered the dump
+   */
+  dumpFlightRecorder(reason) {
+    try {
+      const dump = this.module?.exports?.flight_recorder_dump;
+      if (typeof dump !== 'function') return;
+      console.error(`Flight recorder dump (${reason}):\n${this.readString(dump())}`);
+    } catch (e) {
+      console.error('Failed to dump flight recorder:', e);
+    }
+  }
+
   /**
    * Initialize the WebAssembly module
    * @param {Object} [options] - Options for initialization
@@ -213,6 +228,7 @@ export class WasmManager {
         
         // Standard library functions
         abort: (message, file, line, column) => {
+          this.dumpFlightRecorder('abort');
           throw new Error(`Abort: ${message} at ${file}:${line}:${column}`);
         },
         
@@ -269,6 +285,7 @@ export class WasmManager {
             
             const error = new Error(`WASM Aborted: ${message} at ${file}:${line}:${column}`);
             console.error(error);
+            this.dumpFlightRecorder(message);
             eventBus.emit('wasm:error', { error });
             
             // Don't throw here as it might be caught by the WebAssembly module
@@ -0,0 +1,69 @@
+#include "world/MaterialGrid.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+int s_failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        ++s_failures;
+    }
+}
+
+size_t countCells(const MaterialGrid& grid, Material material) {
+    size_t count = 0;
+    for (uint32_t y = 0; y < grid.getHeight(); ++y) {
+        for (uint32_t x = 0; x < grid.getWidth(); ++x) {
+            count += grid.get(x, y) == material;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+int main() {
+    // Partly outside: clipped to the grid
+    {
+        MaterialGrid grid(16, 8);
+        grid.fillRect(12, 6, 10, 10, Material::Stone);
+        check(countCells(grid, Material::Stone) == 4 * 2, "partial fill is clipped");
+        check(grid.get(15, 7) == Material::Stone, "partial fill reaches the corner");
+        check(grid.get(11, 6) == Material::Air, "partial fill stays in its rect");
+        check(grid.getColumnRevision(12) == grid.getRevision(), "partial fill bumps its columns");
+        check(grid.getColumnRevision(11) == 0, "partial fill leaves other columns");
+    }
+
+    // Entirely outside: nothing changes
+    {
+        MaterialGrid grid(16, 8);
+        grid.fillRect(16, 0, 4, 4, Material::Stone);
+        grid.fillRect(0, 8, 4, 4, Material::Stone);
+        grid.fillRect(100, 100, 4, 4, Material::Stone);
+        check(countCells(grid, Material::Stone) == 0, "fill outside the grid is ignored");
+        check(grid.getRevision() == 0, "fill outside the grid keeps the revision");
+    }
+
+    // Empty rect: nothing changes, so revision watchers don't rebuild
+    {
+        MaterialGrid grid(16, 8);
+        grid.fillRect(2, 2, 0, 4, Material::Stone);
+        grid.fillRect(2, 2, 4, 0, Material::Stone);
+        check(countCells(grid, Material::Stone) == 0, "empty fill changes no cells");
+        check(grid.getRevision() == 0, "empty fill keeps the revision");
+        check(grid.getColumnRevision(2) == 0, "empty fill keeps the column revisions");
+    }
+
+    // Sizes that would wrap x0 + w
+    {
+        MaterialGrid grid(16, 8);
+        grid.fillRect(4, 2, 0xFFFFFFFFu, 0xFFFFFFFFu, Material::Water);
+        check(countCells(grid, Material::Water) == 12 * 6, "wrapping size is clipped");
+    }
+
+    if (s_failures == 0) std::printf("MaterialGridTest passed\n");
+    return s_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}